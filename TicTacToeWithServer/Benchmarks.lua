@@ -0,0 +1,91 @@
+function CreateGridBatchBenchmark(baseFolder, outputFolder)
+	print("GridBatchBenchmark : " .. baseFolder)
+	project "GridBatchBenchmark"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "c++17"
+		targetdir(outputFolder)
+		filter {}
+		targetname "GridBatchBenchmark"
+		
+		files {
+			baseFolder .. "benchmarks/GridBatchBenchmark.cpp",
+			baseFolder .. "src/Game.hpp",
+			baseFolder .. "src/GridBatch.*"
+		}
+		includedirs { baseFolder .. "src" }
+		
+		filter "configurations:Debug"
+			defines { "DEBUG" }
+			symbols "On"
+		
+		filter "configurations:Release"
+			defines { "NDEBUG" }
+			optimize "On"
+		
+		filter {}
+		location("./tmp/builds/projects/" .. _ACTION)
+end
+
+function CreateBatchedSocketBenchmark(baseFolder, outputFolder)
+	print("BatchedSocketBenchmark : " .. baseFolder)
+	project "BatchedSocketBenchmark"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "c++17"
+		targetdir(outputFolder)
+		filter {}
+		targetname "BatchedSocketBenchmark"
+		
+		files {
+			baseFolder .. "benchmarks/BatchedSocketBenchmark.cpp",
+			baseFolder .. "server/BatchedSocket.*"
+		}
+		includedirs { baseFolder .. "server" }
+		
+		filter "configurations:Debug"
+			defines { "DEBUG" }
+			symbols "On"
+		
+		filter "configurations:Release"
+			defines { "NDEBUG" }
+			optimize "On"
+		
+		filter {}
+		location("./tmp/builds/projects/" .. _ACTION)
+end
+
+function CreateProtocolBenchmark(baseFolder, outputFolder)
+	print("ProtocolBenchmark : " .. baseFolder)
+	project "ProtocolBenchmark"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "c++17"
+		targetdir(outputFolder)
+		filter {}
+		targetname "ProtocolBenchmark"
+		
+		files {
+			baseFolder .. "benchmarks/ProtocolBenchmark.cpp",
+			baseFolder .. "src/BitStream.hpp",
+			baseFolder .. "src/Game.hpp",
+			baseFolder .. "src/Net.*"
+		}
+		includedirs {
+			baseFolder .. "src",
+			"Libs/Net/NetworkLib/src"
+		}
+		
+		filter "configurations:Debug"
+			defines { "DEBUG" }
+			symbols "On"
+		
+		filter "configurations:Release"
+			defines { "NDEBUG" }
+			optimize "On"
+		
+		filter {}
+		libdirs { "./tmp/builds/files/" .. _ACTION .. "/%{cfg.buildcfg}" }
+		links { "Network" }
+		location("./tmp/builds/projects/" .. _ACTION)
+end
\ No newline at end of file
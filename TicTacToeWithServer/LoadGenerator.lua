@@ -0,0 +1,44 @@
+function CreateLoadGenerator(baseFolder, outputFolder)
+	print("LoadGenerator : " .. baseFolder)
+	project "LoadGenerator"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "c++17"
+		targetdir(outputFolder)
+		filter {}
+		targetname "LoadGenerator"
+		
+		files {
+			baseFolder .. "loadgen/**",
+			baseFolder .. "src/AddressTable.hpp",
+			baseFolder .. "src/BitStream.hpp",
+			baseFolder .. "src/ClientMatch.*",
+			baseFolder .. "src/CommandLine.hpp",
+			baseFolder .. "src/Game.hpp",
+			baseFolder .. "src/Histogram.hpp",
+			baseFolder .. "src/Net.*",
+			baseFolder .. "src/NetService.*",
+			baseFolder .. "src/OutcomeTable.hpp"
+		}
+		includedirs {
+			baseFolder .. "loadgen",
+			baseFolder .. "src",
+			"Libs/Net/NetworkLib/src"
+		}
+		
+		filter "configurations:Debug"
+			defines { "DEBUG" }
+			symbols "On"
+		
+		filter "configurations:Release"
+			defines { "NDEBUG" }
+			optimize "On"
+		
+		filter {}
+		libdirs { "./tmp/builds/files/" .. _ACTION .. "/%{cfg.buildcfg}" }
+		links { "Network" }
+		filter "system:linux"
+			links { "pthread" }
+		filter {}
+		location("./tmp/builds/projects/" .. _ACTION)
+end
\ No newline at end of file
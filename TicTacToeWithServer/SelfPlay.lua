@@ -0,0 +1,40 @@
+function CreateSelfPlay(baseFolder, outputFolder)
+	print("SelfPlay : " .. baseFolder)
+	project "SelfPlay"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "c++17"
+		targetdir(outputFolder)
+		filter {}
+		targetname "SelfPlay"
+		
+		files {
+			baseFolder .. "selfplay/**",
+			baseFolder .. "src/CommandLine.hpp",
+			baseFolder .. "src/Game.hpp",
+			baseFolder .. "src/MonteCarloTreeSearch.hpp",
+			baseFolder .. "src/OutcomeTable.hpp",
+			baseFolder .. "src/Policy.*",
+			baseFolder .. "src/WorkStealingPool.*"
+		}
+		includedirs { baseFolder .. "src" }
+		
+		filter "configurations:Debug"
+			defines { "DEBUG" }
+			symbols "On"
+		
+		filter "configurations:Release"
+			defines { "NDEBUG" }
+			optimize "On"
+		
+		filter {}
+		-- OutcomeTable is generated at compile time and needs more constexpr evaluation steps than the defaults
+		filter "toolset:msc*"
+			buildoptions { "/constexpr:steps100000000" }
+		filter "toolset:clang"
+			buildoptions { "-fconstexpr-steps=100000000" }
+		filter "system:linux"
+			links { "pthread" }
+		filter {}
+		location("./tmp/builds/projects/" .. _ACTION)
+end
\ No newline at end of file
@@ -33,6 +33,12 @@ function CreateTicTacToeWithServer(baseFolder, outputFolder)
 			"Libs/SDL2/include",
 			"Libs/Net/NetworkLib/src"
 		}
+		-- OutcomeTable is generated at compile time and needs more constexpr evaluation steps than the defaults
+		filter "toolset:msc*"
+			buildoptions { "/constexpr:steps100000000" }
+		filter "toolset:clang"
+			buildoptions { "-fconstexpr-steps=100000000" }
+		filter {}
 		filter "toolset:msc*"
 			libdirs {
 				"Libs/SDL2/lib/vs/x64"
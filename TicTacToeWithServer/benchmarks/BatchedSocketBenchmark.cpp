@@ -0,0 +1,77 @@
+#include <BatchedSocket.hpp>
+
+#include <iostream>
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <string>
+
+// Loopback ping pong of datagram bursts : sender queues a burst and flushes it, receiver drains it
+// Compare packets per second of one syscall per datagram with recvmmsg / sendmmsg batches
+int main(int argc, char* argv[])
+{
+    const size_t datagramsCount = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    constexpr size_t DatagramSize = 16;
+    constexpr size_t BatchSizes[] = { 1, 8, 32, 64, 128 };
+
+    auto run = [&](BatchedSocket::Mode mode, size_t batch)
+    {
+        BatchedSocket::Parameters parameters;
+        parameters.mode = mode;
+        parameters.receiveBatch = batch;
+        parameters.sendBatch = batch;
+        BatchedSocket sender;
+        BatchedSocket receiver;
+        if (!sender.init(parameters) || !receiver.init(parameters))
+        {
+            std::cout << "Socket initialization failed" << std::endl;
+            return;
+        }
+        sockaddr_in target{};
+        target.sin_family = AF_INET;
+        target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        target.sin_port = htons(receiver.port());
+        uint8_t payload[DatagramSize]{};
+
+        size_t sent = 0;
+        size_t received = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (; sent < datagramsCount; sent += batch)
+        {
+            for (size_t i = 0; i < batch; ++i)
+                sender.queue(target, payload, sizeof(payload));
+            sender.flush();
+            size_t count;
+            do
+            {
+                count = receiver.receive();
+                received += count;
+            } while (count == batch);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const uint64_t syscalls = sender.statistics().sendCalls + receiver.statistics().receiveCalls;
+        std::cout << (mode == BatchedSocket::Mode::Batched ? "Batched     " : "PerDatagram ") << "batch " << batch
+            << " : " << (received / elapsed.count() / 1e6) << " M datagrams/s, "
+            << (static_cast<double>(syscalls) / received) << " syscalls per datagram, "
+            << (sent - received) << " lost" << std::endl;
+    };
+    for (size_t batch : BatchSizes)
+    {
+        run(BatchedSocket::Mode::PerDatagram, batch);
+        run(BatchedSocket::Mode::Batched, batch);
+    }
+    return 0;
+}
+
+#else
+
+int main()
+{
+    std::cout << "BatchedSocket needs recvmmsg and sendmmsg : Linux only" << std::endl;
+    return 0;
+}
+
+#endif
\ No newline at end of file
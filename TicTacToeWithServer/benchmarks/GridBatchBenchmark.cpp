@@ -0,0 +1,83 @@
+#include <Game.hpp>
+#include <GridBatch.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Compare GridBatch kernels with replaying each grid through Grid::play and reading winner()
+int main(int argc, char* argv[])
+{
+    const size_t gridsCount = argc > 1 ? std::stoul(argv[1]) : 1 << 20;
+    constexpr int Repeats = 20;
+
+    // Random positions taken from random games, with the moves that lead to them
+    struct Game
+    {
+        std::array<uint8_t, 9> moves;
+        uint8_t movesCount{ 0 };
+    };
+    std::vector<Game> games(gridsCount);
+    TicTacToe::GridBatch batch;
+    batch.reserve(gridsCount);
+    std::mt19937 random(42);
+    for (Game& game : games)
+    {
+        TicTacToe::Grid grid;
+        const unsigned int length = random() % 10;
+        TicTacToe::Case player = TicTacToe::Case::X;
+        while (game.movesCount < length && !grid.isFinished())
+        {
+            const uint8_t move = static_cast<uint8_t>(random() % 9);
+            if (grid.play(move / 3, move % 3, player))
+            {
+                game.moves[game.movesCount++] = move;
+                player = player == TicTacToe::Case::X ? TicTacToe::Case::O : TicTacToe::Case::X;
+            }
+        }
+        batch.add(grid);
+    }
+
+    auto measure = [&](const char* name, auto&& run)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t checksum = 0;
+        for (int i = 0; i < Repeats; ++i)
+            checksum += run();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << " : " << (gridsCount * Repeats / elapsed.count() / 1e6) << " M grids/s (checksum " << checksum << ")" << std::endl;
+    };
+
+    measure("Grid::play + winner()", [&]()
+    {
+        uint64_t checksum = 0;
+        for (const Game& game : games)
+        {
+            TicTacToe::Grid grid;
+            TicTacToe::Case player = TicTacToe::Case::X;
+            for (uint8_t i = 0; i < game.movesCount; ++i)
+            {
+                grid.play(game.moves[i] / 3, game.moves[i] % 3, player);
+                player = player == TicTacToe::Case::X ? TicTacToe::Case::O : TicTacToe::Case::X;
+            }
+            checksum += static_cast<uint64_t>(grid.winner()) + grid.isFinished() + (grid.isFinished() ? 0 : grid.bitboard(TicTacToe::Case::Empty));
+        }
+        return checksum;
+    });
+    for (TicTacToe::GridBatch::Kernel kernel : { TicTacToe::GridBatch::Kernel::Scalar, TicTacToe::GridBatch::Kernel::SSE2, TicTacToe::GridBatch::Kernel::AVX2 })
+    {
+        if (kernel > TicTacToe::GridBatch::BestKernel())
+            break;
+        measure(TicTacToe::GridBatch::KernelName(kernel), [&]()
+        {
+            batch.evaluate(kernel);
+            uint64_t checksum = 0;
+            for (size_t i = 0; i < batch.size(); ++i)
+                checksum += static_cast<uint64_t>(batch.winner(i)) + batch.isFinished(i) + (batch.isFinished(i) ? 0 : batch.legalMoves(i));
+            return checksum;
+        });
+    }
+    return 0;
+}
\ No newline at end of file
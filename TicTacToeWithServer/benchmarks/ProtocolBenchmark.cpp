@@ -0,0 +1,205 @@
+#include <Game.hpp>
+#include <Net.hpp>
+
+#include <Serialization/Deserializer.hpp>
+#include <Serialization/Serializer.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Packets must survive messages which fail to encode : each one is dropped whole, the others still decode
+static bool CheckPackets()
+{
+    std::array<uint8_t, 8> buffer;
+    buffer.fill(0xFF);
+    TicTacToe::Net::PacketWriter writer(buffer.data(), buffer.size());
+    TicTacToe::Net::Play play;
+    play.x = 1;
+    play.y = 2;
+    TicTacToe::Net::Start empty;
+    empty.symbol = TicTacToe::Case::Empty;
+    TicTacToe::Net::Delta outOfRange;
+    outOfRange.sequence = 10;
+    TicTacToe::Net::Delta delta;
+    delta.sequence = 3;
+    delta.x = 2;
+    delta.y = 0;
+    if (!writer.write(play) || writer.write(empty) || writer.write(outOfRange) || !writer.write(delta))
+        return false;
+
+    TicTacToe::Net::PacketReader reader(buffer.data(), writer.size());
+    TicTacToe::Net::MessageType type;
+    TicTacToe::Net::Play readPlay;
+    TicTacToe::Net::Delta readDelta;
+    return reader.next(type) && type == TicTacToe::Net::MessageType::Play && reader.read(readPlay) && readPlay.x == 1 && readPlay.y == 2
+        && reader.next(type) && type == TicTacToe::Net::MessageType::Delta && reader.read(readDelta) && readDelta.sequence == 3 && readDelta.x == 2 && readDelta.y == 0
+        && !reader.next(type);
+}
+
+// Snapshots of positions no game reaches are rejected : a hostile one can't make up a winner
+static bool CheckSnapshots()
+{
+    // Cases in x * 3 + y order
+    auto snapshotOf = [](const char* cases)
+    {
+        TicTacToe::Net::Snapshot snapshot;
+        for (unsigned int i = 0; i < 9; ++i)
+        {
+            const TicTacToe::Case owner = cases[i] == 'X' ? TicTacToe::Case::X : cases[i] == 'O' ? TicTacToe::Case::O : TicTacToe::Case::Empty;
+            snapshot.board |= static_cast<uint32_t>(owner) << (2 * i);
+        }
+        return snapshot;
+    };
+    TicTacToe::Grid grid;
+    // X won with its last move : taking it back gives a running game
+    if (!snapshotOf("XXX.OO...").restore(grid) || grid.winner() != TicTacToe::Case::X || !grid.unplay() || grid.isFinished())
+        return false;
+    // Both have a line, X has one but O moved after it, O has one but X moved after it
+    return !snapshotOf("XXXOOOX..").restore(grid)
+        && !snapshotOf("XXXOO.O..").restore(grid)
+        && !snapshotOf("OOOXX.XX.").restore(grid);
+}
+
+// Compare the bit packed packet protocol with the type prefixed Bousk Serializer encoding
+// Encode and decode throughput of Play messages, then payload bytes of whole matches
+int main(int argc, char* argv[])
+{
+    if (!CheckPackets())
+    {
+        std::cout << "Packet check failed" << std::endl;
+        return -1;
+    }
+    if (!CheckSnapshots())
+    {
+        std::cout << "Snapshot check failed" << std::endl;
+        return -1;
+    }
+
+    const size_t messagesCount = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    constexpr size_t MatchesCount = 100000;
+
+    std::mt19937 random(42);
+    std::vector<TicTacToe::Net::Play> plays(1024);
+    for (TicTacToe::Net::Play& play : plays)
+    {
+        play.x = static_cast<uint8_t>(random() % 3);
+        play.y = static_cast<uint8_t>(random() % 3);
+    }
+
+    auto measure = [&](const char* name, auto&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t checksum = 0;
+        for (size_t i = 0; i < messagesCount; ++i)
+            checksum += function(plays[i % plays.size()]);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << name << " : " << (messagesCount / elapsed.count() / 1e6) << " M messages/s (checksum " << checksum << ")" << std::endl;
+    };
+
+    // Encoding
+    measure("Serializer encode", [](const TicTacToe::Net::Play& play) -> uint64_t
+    {
+        Bousk::Serialization::Serializer serializer;
+        TicTacToe::Net::Write(serializer, play);
+        return serializer.bufferSize();
+    });
+    measure("Packet encode    ", [](const TicTacToe::Net::Play& play) -> uint64_t
+    {
+        std::array<uint8_t, 8> buffer;
+        TicTacToe::Net::PacketWriter writer(buffer.data(), buffer.size());
+        writer.write(play);
+        return writer.size();
+    });
+
+    // Decoding
+    std::vector<std::vector<uint8_t>> serialized;
+    std::vector<std::array<uint8_t, 8>> packets(plays.size());
+    std::vector<size_t> packetSizes;
+    for (size_t i = 0; i < plays.size(); ++i)
+    {
+        Bousk::Serialization::Serializer serializer;
+        TicTacToe::Net::Write(serializer, plays[i]);
+        serialized.emplace_back(serializer.buffer(), serializer.buffer() + serializer.bufferSize());
+        TicTacToe::Net::PacketWriter writer(packets[i].data(), packets[i].size());
+        writer.write(plays[i]);
+        packetSizes.push_back(writer.size());
+    }
+    size_t index = 0;
+    measure("Serializer decode", [&](const TicTacToe::Net::Play&) -> uint64_t
+    {
+        const std::vector<uint8_t>& data = serialized[index++ % serialized.size()];
+        Bousk::Serialization::Deserializer deserializer(data.data(), data.size());
+        TicTacToe::Net::MessageType type;
+        TicTacToe::Net::Play play;
+        if (!TicTacToe::Net::ReadType(deserializer, type) || !play.read(deserializer))
+            return 0;
+        return play.x * 3 + play.y;
+    });
+    index = 0;
+    measure("Packet decode    ", [&](const TicTacToe::Net::Play&) -> uint64_t
+    {
+        const size_t i = index++ % packets.size();
+        TicTacToe::Net::PacketReader reader(packets[i].data(), packetSizes[i]);
+        TicTacToe::Net::MessageType type;
+        TicTacToe::Net::Play play;
+        if (!reader.next(type) || !reader.read(play))
+            return 0;
+        return play.x * 3 + play.y;
+    });
+
+    // Payload bytes of random matches as played through the server : one Start per player,
+    // then each move sent by its player and relayed to the opponent, one message per datagram
+    uint64_t serializerBytes = 0;
+    uint64_t packetBytes = 0;
+    uint64_t packedBytes = 0;
+    uint64_t moves = 0;
+    for (size_t match = 0; match < MatchesCount; ++match)
+    {
+        TicTacToe::Grid grid;
+        TicTacToe::Case player = TicTacToe::Case::X;
+        for (TicTacToe::Case symbol : { TicTacToe::Case::X, TicTacToe::Case::O })
+        {
+            TicTacToe::Net::Start start;
+            start.symbol = symbol;
+            Bousk::Serialization::Serializer serializer;
+            TicTacToe::Net::Write(serializer, start);
+            serializerBytes += serializer.bufferSize();
+            std::array<uint8_t, 8> buffer;
+            TicTacToe::Net::PacketWriter writer(buffer.data(), buffer.size());
+            writer.write(start);
+            packetBytes += writer.size();
+        }
+        // Packed : the whole match replayed in one datagram, as a spectator joining late would get it
+        std::array<uint8_t, 16> matchBuffer;
+        TicTacToe::Net::PacketWriter matchWriter(matchBuffer.data(), matchBuffer.size());
+        while (!grid.isFinished())
+        {
+            TicTacToe::Net::Play play;
+            play.x = static_cast<uint8_t>(random() % 3);
+            play.y = static_cast<uint8_t>(random() % 3);
+            if (!grid.play(play.x, play.y, player))
+                continue;
+            player = player == TicTacToe::Case::X ? TicTacToe::Case::O : TicTacToe::Case::X;
+            ++moves;
+            Bousk::Serialization::Serializer serializer;
+            TicTacToe::Net::Write(serializer, play);
+            serializerBytes += 2 * serializer.bufferSize();
+            std::array<uint8_t, 8> buffer;
+            TicTacToe::Net::PacketWriter writer(buffer.data(), buffer.size());
+            writer.write(play);
+            packetBytes += 2 * writer.size();
+            matchWriter.write(play);
+        }
+        packedBytes += matchWriter.size();
+    }
+    std::cout << "Payload per match, " << (static_cast<double>(moves) / MatchesCount) << " moves on average :" << std::endl;
+    std::cout << "  Serializer        " << (static_cast<double>(serializerBytes) / MatchesCount) << " bytes" << std::endl;
+    std::cout << "  Packet            " << (static_cast<double>(packetBytes) / MatchesCount) << " bytes" << std::endl;
+    std::cout << "  Packed moves      " << (static_cast<double>(packedBytes) / MatchesCount) << " bytes in one datagram" << std::endl;
+    std::cout << "  Packed snapshot   " << ((TicTacToe::Net::MessageIdBits + TicTacToe::Net::Snapshot::Bits + 7) / 8) << " bytes in one datagram" << std::endl;
+    return 0;
+}
\ No newline at end of file
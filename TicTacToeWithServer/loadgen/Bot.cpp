@@ -0,0 +1,189 @@
+#include <Bot.hpp>
+
+#include <OutcomeTable.hpp>
+
+namespace
+{
+	template<class Duration>
+	uint64_t Since(std::chrono::steady_clock::time_point start)
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - start).count());
+	}
+}
+
+Bot::Bot(uint32_t seed, Policy policy, bool spectator)
+	: mRandom(seed | 1)
+	, mPolicy(policy)
+	, mSpectator(spectator)
+{
+	mNetService.addListener(this);
+}
+Bot::~Bot()
+{
+	stop();
+	mNetService.removeListener(this);
+}
+
+bool Bot::start(const Bousk::Network::Address& server)
+{
+	NetService::Parameters netServiceParameters;
+	netServiceParameters.networked = true;
+	netServiceParameters.hostAddress = server;
+	mServer = server;
+	mStarted = std::chrono::steady_clock::now();
+	return mNetService.init(netServiceParameters);
+}
+void Bot::stop()
+{
+	if (mNetService.isInitialized())
+		mNetService.release();
+	mStatistics.connected = false;
+}
+void Bot::update(Timings& timings)
+{
+	mTimings = &timings;
+	if (mReconnect)
+	{
+		mReconnect = false;
+		++mStatistics.reconnections;
+		stop();
+		if (!start(mServer))
+		{
+			mTimings = nullptr;
+			return;
+		}
+	}
+	mNetService.receive();
+	mNetService.process();
+	// Out of sync : ask for the board until the request goes out, nothing is played meanwhile
+	if (mMatch.needsResync() && send(TicTacToe::Net::Resync()))
+		mMatch.resyncSent();
+	mNetService.flush();
+	mTimings = nullptr;
+}
+
+void Bot::onConnectionResult(const Bousk::Network::Messages::Connection& connection)
+{
+	mStatistics.connected = connection.result == Bousk::Network::Messages::Connection::Result::Success;
+	if (!mStatistics.connected)
+		return;
+	mTimings->connect.add(Since<std::chrono::microseconds>(mStarted));
+	if (mSpectator)
+		send(TicTacToe::Net::Spectate());
+	else if (mMatch.canRejoin())
+		send(mMatch.rejoin());
+	else
+		send(TicTacToe::Net::Hello());
+}
+void Bot::onDisconnection(const Bousk::Network::Messages::Disconnection&)
+{
+	mStatistics.connected = false;
+	// Its seat is kept for a while : get it back rather than leaving the opponent a forfeit
+	if (mMatch.canRejoin())
+		mReconnect = true;
+}
+void Bot::onDataReceived(const Bousk::Network::Messages::UserData& userData)
+{
+	TicTacToe::Net::PacketReader reader(userData.data.data(), userData.data.size());
+	TicTacToe::Net::MessageType type;
+	while (reader.next(type))
+	{
+		switch (type)
+		{
+			case TicTacToe::Net::MessageType::Start:
+			{
+				TicTacToe::Net::Start start;
+				if (!reader.read(start))
+					return;
+				++mStatistics.matchesStarted;
+				mMatch.start(start.symbol);
+				mAwaitingReply = false;
+				mMatchStarted = std::chrono::steady_clock::now();
+			} break;
+			case TicTacToe::Net::MessageType::Seat:
+			{
+				TicTacToe::Net::Seat seat;
+				if (!reader.read(seat))
+					return;
+				mMatch.seat(seat);
+			} break;
+			case TicTacToe::Net::MessageType::Delta:
+			{
+				TicTacToe::Net::Delta delta;
+				if (!reader.read(delta))
+					return;
+				const TicTacToe::Net::ClientMatch::DeltaResult result = mMatch.apply(delta);
+				if (result == TicTacToe::Net::ClientMatch::DeltaResult::OutOfSync)
+					++mStatistics.resyncs;
+				if (result != TicTacToe::Net::ClientMatch::DeltaResult::Applied)
+					break;
+				++mStatistics.movesReceived;
+				if (mAwaitingReply)
+				{
+					mTimings->moveRoundTrip.add(Since<std::chrono::microseconds>(mMoveSent));
+					mAwaitingReply = false;
+				}
+				if (mMatch.grid().isFinished() && !mSpectator)
+					mTimings->matchDuration.add(Since<std::chrono::milliseconds>(mMatchStarted));
+			} break;
+			case TicTacToe::Net::MessageType::Snapshot:
+			{
+				TicTacToe::Net::Snapshot snapshot;
+				if (!reader.read(snapshot) || !mMatch.restore(snapshot))
+					return;
+				++mStatistics.snapshotsReceived;
+			} break;
+			default:
+				return;
+		}
+	}
+	if (mMatch.isMyTurn())
+		playMove();
+}
+
+void Bot::playMove()
+{
+	unsigned int index = TicTacToe::OutcomeTable::NoMove;
+	if (mPolicy == Policy::Perfect)
+		index = TicTacToe::OutcomeTable::Lookup(mMatch.grid()).move;
+	if (index == TicTacToe::OutcomeTable::NoMove)
+		index = randomMove();
+
+	TicTacToe::Net::Play play;
+	play.x = static_cast<uint8_t>(index / 3);
+	play.y = static_cast<uint8_t>(index % 3);
+	mMatch.play(index / 3, index % 3);
+
+	if (!send(play))
+		return;
+	++mStatistics.movesSent;
+	if (mMatch.grid().isFinished())
+	{
+		mTimings->matchDuration.add(Since<std::chrono::milliseconds>(mMatchStarted));
+		return;
+	}
+	mMoveSent = std::chrono::steady_clock::now();
+	mAwaitingReply = true;
+}
+unsigned int Bot::randomMove()
+{
+	mRandom ^= mRandom << 13;
+	mRandom ^= mRandom >> 17;
+	mRandom ^= mRandom << 5;
+	uint16_t free = mMatch.grid().bitboard(TicTacToe::Case::Empty);
+	unsigned int freeCount = 0;
+	for (uint16_t bits = free; bits; bits &= bits - 1)
+		++freeCount;
+	// Drop the lowest free cases until reaching the chosen one
+	for (unsigned int skip = mRandom % freeCount; skip; --skip)
+		free &= free - 1;
+	unsigned int index = 0;
+	while (!(free & (1u << index)))
+		++index;
+	return index;
+}
+template<class Message>
+bool Bot::send(const Message& message)
+{
+	return mNetService.send(mServer, message);
+}
\ No newline at end of file
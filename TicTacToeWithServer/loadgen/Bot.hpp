@@ -0,0 +1,84 @@
+#pragma once
+
+#include <ClientMatch.hpp>
+#include <Game.hpp>
+#include <Histogram.hpp>
+#include <Net.hpp>
+#include <NetService.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+// Headless client playing moves from a policy against the match server as fast as it can, or watching its featured match
+class Bot : public NetService::IListener
+{
+public:
+	struct Statistics
+	{
+		uint64_t matchesStarted{ 0 };
+		uint64_t movesSent{ 0 };
+		uint64_t movesReceived{ 0 };
+		uint64_t resyncs{ 0 };
+		uint64_t snapshotsReceived{ 0 };
+		// Connections lost during a match, and started again to rejoin it
+		uint64_t reconnections{ 0 };
+		bool connected{ false };
+	};
+	enum class Policy
+	{
+		Random,
+		// Best move from the outcome table
+		Perfect,
+	};
+	// Recorded by the bots of a thread in the same histograms : no per bot histogram memory and no contention
+	struct Timings
+	{
+		// Microseconds from start() to the connection
+		Histogram connect;
+		// Microseconds from sending a move to receiving the opponent one, relayed by the server both ways
+		Histogram moveRoundTrip;
+		// Milliseconds from Start to the end of the match
+		Histogram matchDuration;
+	};
+public:
+	explicit Bot(uint32_t seed, Policy policy = Policy::Random, bool spectator = false);
+	~Bot();
+
+	bool start(const Bousk::Network::Address& server);
+	void stop();
+	// Receive, process and send network data, recording timings of what happened
+	void update(Timings& timings);
+
+	const Statistics& statistics() const { return mStatistics; }
+	// Telemetry of the connection to the server
+	bool sampleConnection(NetService::ConnectionSample& sample) const { return mNetService.sampleConnection(0, sample); }
+
+private:
+	void onConnectionResult(const Bousk::Network::Messages::Connection& connection) override;
+	void onDisconnection(const Bousk::Network::Messages::Disconnection& disconnection) override;
+	void onDataReceived(const Bousk::Network::Messages::UserData& userData) override;
+
+	void playMove();
+	unsigned int randomMove();
+	template<class Message>
+	bool send(const Message& message);
+
+private:
+	NetService mNetService;
+	Bousk::Network::Address mServer;
+	TicTacToe::Net::ClientMatch mMatch;
+	// xorshift state, never 0
+	uint32_t mRandom;
+	Policy mPolicy;
+	// Watch the server featured match instead of playing
+	bool mSpectator;
+	Statistics mStatistics;
+	Timings* mTimings{ nullptr };
+	std::chrono::steady_clock::time_point mStarted;
+	std::chrono::steady_clock::time_point mMatchStarted;
+	std::chrono::steady_clock::time_point mMoveSent;
+	// A move was sent and the opponent one is awaited
+	bool mAwaitingReply{ false };
+	// Connection lost during a match : connect again on next update, and Rejoin
+	bool mReconnect{ false };
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <Impairment.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	std::vector<uint32_t> AllSlots(size_t capacity)
+	{
+		std::vector<uint32_t> slots(capacity);
+		// Lowest slots first
+		for (size_t i = 0; i < capacity; ++i)
+			slots[i] = static_cast<uint32_t>(capacity - 1 - i);
+		return slots;
+	}
+}
+
+Impairment::Impairment(const Parameters& parameters)
+	: mParameters(parameters)
+	, mDatagrams(parameters.capacity)
+	, mFree(AllSlots(parameters.capacity))
+	// xorshift state must not be 0
+	, mRandom(parameters.seed * 0x9E3779B97F4A7C15ull | 1)
+{
+	std::vector<Scheduled> scheduled;
+	scheduled.reserve(parameters.capacity);
+	mScheduled = decltype(mScheduled)(std::greater<Scheduled>(), std::move(scheduled));
+}
+
+void Impairment::push(Clock::time_point now, uint32_t route, const uint8_t* data, size_t size)
+{
+	++mStatistics.received;
+	if (size > MaxDatagramSize || random() < mParameters.loss)
+	{
+		++mStatistics.dropped;
+		return;
+	}
+	if (mFree.empty())
+	{
+		++mStatistics.dropped;
+		++mStatistics.overflowed;
+		return;
+	}
+	Clock::time_point sent = now;
+	if (mParameters.bandwidth)
+	{
+		mLinkFree = std::max(mLinkFree, now) + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(static_cast<double>(size) / mParameters.bandwidth));
+		sent = mLinkFree;
+	}
+	Clock::time_point due = sent + mParameters.latency + jitter();
+	if (random() < mParameters.reordering)
+	{
+		due += mParameters.reorderDelay;
+		++mStatistics.reordered;
+	}
+	schedule(due, route, data, size);
+	// The copy takes its own path : its own jitter, never reordered on purpose
+	if (random() < mParameters.duplication && schedule(sent + mParameters.latency + jitter(), route, data, size))
+		++mStatistics.duplicated;
+}
+
+bool Impairment::schedule(Clock::time_point due, uint32_t route, const uint8_t* data, size_t size)
+{
+	if (mFree.empty())
+		return false;
+	const uint32_t slot = mFree.back();
+	mFree.pop_back();
+	Datagram& datagram = mDatagrams[slot];
+	datagram.route = route;
+	datagram.size = static_cast<uint16_t>(size);
+	std::memcpy(datagram.data.data(), data, size);
+	mScheduled.push({ due, mOrder++, slot });
+	return true;
+}
+double Impairment::random()
+{
+	// xorshift64*
+	mRandom ^= mRandom >> 12;
+	mRandom ^= mRandom << 25;
+	mRandom ^= mRandom >> 27;
+	return static_cast<double>((mRandom * 0x2545F4914F6CDD1Dull) >> 11) * (1. / 9007199254740992.);
+}
+Impairment::Clock::duration Impairment::jitter()
+{
+	return Clock::duration(static_cast<Clock::rep>(random() * static_cast<double>(mParameters.jitter.count())));
+}
\ No newline at end of file
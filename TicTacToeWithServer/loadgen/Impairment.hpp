@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Network conditions applied to a stream of datagrams : latency, jitter, loss, duplication, reordering and bandwidth cap
+// Every random draw comes from the seed : the same seed and the same traffic give the same run
+// Datagrams are copied into fixed slots allocated once, capacity bounds them like a router buffer
+class Impairment
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	static constexpr size_t MaxDatagramSize = 1400;
+	struct Parameters
+	{
+		Clock::duration latency{ 0 };
+		// Extra delay of each datagram, uniform in [0, jitter] : datagrams closer than that can overtake each other
+		Clock::duration jitter{ 0 };
+		// Probabilities in [0, 1]
+		float loss{ 0.f };
+		float duplication{ 0.f };
+		// Held back by reorderDelay, so the following datagrams overtake it
+		float reordering{ 0.f };
+		Clock::duration reorderDelay{ std::chrono::milliseconds(10) };
+		// Bytes per second, 0 for no cap : datagrams leave one after the other at that rate
+		uint64_t bandwidth{ 0 };
+		// Datagrams held at most, more are dropped
+		size_t capacity{ 4096 };
+		uint64_t seed{ 1 };
+	};
+	struct Statistics
+	{
+		uint64_t received{ 0 };
+		uint64_t dropped{ 0 };
+		// Dropped because capacity datagrams were already held
+		uint64_t overflowed{ 0 };
+		uint64_t duplicated{ 0 };
+		uint64_t reordered{ 0 };
+		uint64_t delivered{ 0 };
+		uint64_t deliveredBytes{ 0 };
+	};
+public:
+	explicit Impairment(const Parameters& parameters);
+	~Impairment() = default;
+
+	// Copy datagram received at now, to be delivered to route once its delay is over, or not
+	void push(Clock::time_point now, uint32_t route, const uint8_t* data, size_t size);
+	// Call deliver(route, data, size) for each datagram due at now, in due order
+	template<class Deliver>
+	void deliver(Clock::time_point now, Deliver&& deliver)
+	{
+		while (!mScheduled.empty() && mScheduled.top().due <= now)
+		{
+			const uint32_t slot = mScheduled.top().slot;
+			mScheduled.pop();
+			const Datagram& datagram = mDatagrams[slot];
+			deliver(datagram.route, datagram.data.data(), static_cast<size_t>(datagram.size));
+			++mStatistics.delivered;
+			mStatistics.deliveredBytes += datagram.size;
+			mFree.push_back(slot);
+		}
+	}
+	// When the next datagram is due, Clock::time_point::max() if none is held
+	Clock::time_point nextDue() const { return mScheduled.empty() ? Clock::time_point::max() : mScheduled.top().due; }
+
+	const Statistics& statistics() const { return mStatistics; }
+
+private:
+	bool schedule(Clock::time_point due, uint32_t route, const uint8_t* data, size_t size);
+	// Uniform in [0, 1)
+	double random();
+	Clock::duration jitter();
+
+private:
+	struct Datagram
+	{
+		uint32_t route;
+		uint16_t size;
+		std::array<uint8_t, MaxDatagramSize> data;
+	};
+	struct Scheduled
+	{
+		Clock::time_point due;
+		// Datagrams due at the same time keep their order
+		uint64_t order;
+		uint32_t slot;
+
+		bool operator>(const Scheduled& other) const { return due != other.due ? due > other.due : order > other.order; }
+	};
+	Parameters mParameters;
+	std::vector<Datagram> mDatagrams;
+	std::vector<uint32_t> mFree;
+	std::priority_queue<Scheduled, std::vector<Scheduled>, std::greater<Scheduled>> mScheduled;
+	// When the link is done sending the datagrams already accepted
+	Clock::time_point mLinkFree;
+	uint64_t mOrder{ 0 };
+	uint64_t mRandom;
+	Statistics mStatistics;
+};
\ No newline at end of file
@@ -0,0 +1,181 @@
+#if defined(__linux__)
+
+#include <ImpairmentProxy.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+	bool SetNonBlocking(int socket)
+	{
+		return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK) == 0;
+	}
+	// Epoll data of the clients socket. Server sockets use their route.
+	constexpr uint64_t ClientsSocket = UINT64_MAX;
+	// Longest wait without any datagram due, so stop() is noticed
+	constexpr int IdleTimeoutMs = 10;
+}
+
+ImpairmentProxy::~ImpairmentProxy()
+{
+	stop();
+}
+
+bool ImpairmentProxy::start(const Parameters& parameters)
+{
+	if (mRunning)
+		return false;
+	mClients.clear();
+	mRoutes.clear();
+	mSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	mEpoll = epoll_create1(0);
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	socklen_t length = sizeof(address);
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u64 = ClientsSocket;
+	if (mSocket < 0 || mEpoll < 0
+		|| bind(mSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+		|| getsockname(mSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0
+		|| !SetNonBlocking(mSocket)
+		|| epoll_ctl(mEpoll, EPOLL_CTL_ADD, mSocket, &event) != 0)
+	{
+		stop();
+		return false;
+	}
+	mPort = ntohs(address.sin_port);
+	mServer.sin_family = AF_INET;
+	mServer.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	mServer.sin_port = htons(parameters.serverPort);
+	mToServer = std::make_unique<Impairment>(parameters.toServer);
+	mToClients = std::make_unique<Impairment>(parameters.toClients);
+	mRunning = true;
+	mThread = std::thread([this]() { run(); });
+	return true;
+}
+void ImpairmentProxy::stop()
+{
+	mRunning = false;
+	if (mThread.joinable())
+		mThread.join();
+	// Clients are kept for the statistics
+	for (Client& client : mClients)
+	{
+		close(client.socket);
+		client.socket = -1;
+	}
+	if (mEpoll >= 0)
+		close(mEpoll);
+	if (mSocket >= 0)
+		close(mSocket);
+	mEpoll = -1;
+	mSocket = -1;
+}
+ImpairmentProxy::Statistics ImpairmentProxy::statistics() const
+{
+	Statistics statistics;
+	if (mToServer)
+		statistics.toServer = mToServer->statistics();
+	if (mToClients)
+		statistics.toClients = mToClients->statistics();
+	statistics.clients = mRoutes.size();
+	return statistics;
+}
+
+void ImpairmentProxy::run()
+{
+	std::array<epoll_event, 64> events;
+	while (mRunning)
+	{
+		Impairment::Clock::time_point now = Impairment::Clock::now();
+		mToServer->deliver(now, [&](uint32_t route, const uint8_t* data, size_t size)
+		{
+			send(mClients[route].socket, data, size, 0);
+		});
+		mToClients->deliver(now, [&](uint32_t route, const uint8_t* data, size_t size)
+		{
+			sendto(mSocket, data, size, 0, reinterpret_cast<const sockaddr*>(&mClients[route].address), sizeof(sockaddr_in));
+		});
+
+		// Sleep until a datagram comes in or one is due. epoll has a millisecond resolution : round up so nothing is sent early.
+		const Impairment::Clock::time_point due = std::min(mToServer->nextDue(), mToClients->nextDue());
+		int timeoutMs = IdleTimeoutMs;
+		if (due != Impairment::Clock::time_point::max())
+		{
+			const auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+			timeoutMs = static_cast<int>(std::clamp<decltype(wait)>(wait, 0, IdleTimeoutMs));
+		}
+		const int count = epoll_wait(mEpoll, events.data(), static_cast<int>(events.size()), timeoutMs);
+		now = Impairment::Clock::now();
+		for (int i = 0; i < count; ++i)
+		{
+			if (events[i].data.u64 == ClientsSocket)
+				receiveFromClients(now);
+			else
+				receiveFromServer(static_cast<uint32_t>(events[i].data.u64), now);
+		}
+	}
+}
+void ImpairmentProxy::receiveFromClients(Impairment::Clock::time_point now)
+{
+	std::array<uint8_t, Impairment::MaxDatagramSize> buffer;
+	for (;;)
+	{
+		sockaddr_in address{};
+		socklen_t length = sizeof(address);
+		const ssize_t size = recvfrom(mSocket, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&address), &length);
+		if (size < 0)
+			return;
+		const uint32_t route = routeOf(address);
+		if (route != UINT32_MAX)
+			mToServer->push(now, route, buffer.data(), static_cast<size_t>(size));
+	}
+}
+void ImpairmentProxy::receiveFromServer(uint32_t route, Impairment::Clock::time_point now)
+{
+	std::array<uint8_t, Impairment::MaxDatagramSize> buffer;
+	for (;;)
+	{
+		const ssize_t size = recv(mClients[route].socket, buffer.data(), buffer.size(), 0);
+		if (size < 0)
+			return;
+		mToClients->push(now, route, buffer.data(), static_cast<size_t>(size));
+	}
+}
+uint32_t ImpairmentProxy::routeOf(const sockaddr_in& address)
+{
+	const uint64_t key = (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port;
+	const auto found = mRoutes.find(key);
+	if (found != mRoutes.end())
+		return found->second;
+
+	const int serverSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	const uint32_t route = static_cast<uint32_t>(mClients.size());
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.u64 = route;
+	if (serverSocket < 0
+		|| connect(serverSocket, reinterpret_cast<const sockaddr*>(&mServer), sizeof(mServer)) != 0
+		|| !SetNonBlocking(serverSocket)
+		|| epoll_ctl(mEpoll, EPOLL_CTL_ADD, serverSocket, &event) != 0)
+	{
+		if (serverSocket >= 0)
+			close(serverSocket);
+		return UINT32_MAX;
+	}
+	mClients.push_back({ address, serverSocket });
+	mRoutes.emplace(key, route);
+	return route;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+// Linux only : relies on epoll
+#if defined(__linux__)
+
+#include <Impairment.hpp>
+
+#include <netinet/in.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// UDP relay on loopback applying an Impairment to each direction between clients and a server
+// Clients connect to port() instead of the server. Each client gets its own socket toward the server, so the server
+// still sees one address per client. The library reliable channels run on both ends, they face the impaired link as is.
+class ImpairmentProxy
+{
+public:
+	struct Parameters
+	{
+		uint16_t serverPort{ 0 };
+		Impairment::Parameters toServer;
+		Impairment::Parameters toClients;
+	};
+	struct Statistics
+	{
+		Impairment::Statistics toServer;
+		Impairment::Statistics toClients;
+		size_t clients{ 0 };
+	};
+public:
+	ImpairmentProxy() = default;
+	~ImpairmentProxy();
+	ImpairmentProxy(const ImpairmentProxy&) = delete;
+	ImpairmentProxy& operator=(const ImpairmentProxy&) = delete;
+
+	// Bind a loopback port for the clients and start relaying
+	bool start(const Parameters& parameters);
+	void stop();
+	uint16_t port() const { return mPort; }
+	// Only valid once stopped
+	Statistics statistics() const;
+
+private:
+	void run();
+	void receiveFromClients(Impairment::Clock::time_point now);
+	void receiveFromServer(uint32_t route, Impairment::Clock::time_point now);
+	// Route of the client at address, a new one with its own server socket the first time
+	uint32_t routeOf(const sockaddr_in& address);
+
+private:
+	struct Client
+	{
+		sockaddr_in address;
+		// Connected to the server
+		int socket;
+	};
+	int mSocket{ -1 };
+	int mEpoll{ -1 };
+	uint16_t mPort{ 0 };
+	sockaddr_in mServer{};
+	std::unique_ptr<Impairment> mToServer;
+	std::unique_ptr<Impairment> mToClients;
+	std::vector<Client> mClients;
+	// Client address as ip << 16 | port
+	std::unordered_map<uint64_t, uint32_t> mRoutes;
+	std::atomic<bool> mRunning{ false };
+	std::thread mThread;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include <Bot.hpp>
+#include <ImpairmentProxy.hpp>
+
+#include <Address.hpp>
+#include <CommandLine.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr Bousk::uint16 HostPort = 8888;
+
+static void PrintPercentiles(const char* name, const Histogram& histogram, const char* unit)
+{
+    std::cout << "  " << name << " : p50 " << histogram.percentile(50) << unit << ", p99 " << histogram.percentile(99) << unit
+        << ", p999 " << histogram.percentile(99.9) << unit << ", max " << histogram.max() << unit << " (" << histogram.count() << " samples)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t botsCount = 1000;
+    size_t spectatorsCount = 0;
+    unsigned int threadsCount = std::max(1u, std::thread::hardware_concurrency());
+    Bousk::uint16 port = HostPort;
+    unsigned int shardsCount = 1;
+    unsigned int duration = 30;
+    Bot::Policy policy = Bot::Policy::Random;
+    // Applied to both directions, each with its own seed
+    Impairment::Parameters impairment;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        bool valid = true;
+        uint32_t milliseconds = 0;
+        float percent = 0.f;
+        uint64_t kilobytes = 0;
+        if (arg.rfind("-bots:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(6), botsCount, 1);
+        else if (arg.rfind("-spectators:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(12), spectatorsCount);
+        else if (arg.rfind("-threads:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(9), threadsCount, 1);
+        else if (arg.rfind("-port:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(6), port, 1);
+        else if (arg.rfind("-shards:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(8), shardsCount, 1);
+        else if (arg.rfind("-duration:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(10), duration, 1);
+        else if (arg == "-policy:random")
+            policy = Bot::Policy::Random;
+        else if (arg == "-policy:perfect")
+            policy = Bot::Policy::Perfect;
+        else if (arg.rfind("-latency:", 0) == 0)
+        {
+            valid = CommandLine::ParseInteger(arg.substr(9), milliseconds);
+            impairment.latency = std::chrono::milliseconds(milliseconds);
+        }
+        else if (arg.rfind("-jitter:", 0) == 0)
+        {
+            valid = CommandLine::ParseInteger(arg.substr(8), milliseconds);
+            impairment.jitter = std::chrono::milliseconds(milliseconds);
+        }
+        else if (arg.rfind("-loss:", 0) == 0)
+        {
+            valid = CommandLine::ParseFloat(arg.substr(6), percent, 0.f, 100.f);
+            impairment.loss = percent / 100.f;
+        }
+        else if (arg.rfind("-duplicate:", 0) == 0)
+        {
+            valid = CommandLine::ParseFloat(arg.substr(11), percent, 0.f, 100.f);
+            impairment.duplication = percent / 100.f;
+        }
+        else if (arg.rfind("-reorder:", 0) == 0)
+        {
+            valid = CommandLine::ParseFloat(arg.substr(9), percent, 0.f, 100.f);
+            impairment.reordering = percent / 100.f;
+        }
+        else if (arg.rfind("-bandwidth:", 0) == 0)
+        {
+            // Bytes per second must not overflow
+            valid = CommandLine::ParseInteger(arg.substr(11), kilobytes, 0, std::numeric_limits<uint64_t>::max() / 1000);
+            impairment.bandwidth = kilobytes * 1000;
+        }
+        else if (arg.rfind("-seed:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(6), impairment.seed);
+        else
+            valid = false;
+        if (!valid)
+        {
+            std::cout << "Usage : " << argv[0] << " [-bots:N] [-spectators:N] [-threads:N] [-port:N] [-shards:N] [-duration:seconds] [-policy:random|perfect]" << std::endl;
+            std::cout << "  Impairment : [-latency:ms] [-jitter:ms] [-loss:%] [-duplicate:%] [-reorder:%] [-bandwidth:KB/s] [-seed:N]" << std::endl;
+            return -1;
+        }
+    }
+    // Each shard listens on its own port
+    if (shardsCount > 65536u - port)
+    {
+        std::cout << shardsCount << " shards need as many ports from " << port << " up to 65535" << std::endl;
+        return -1;
+    }
+
+    const bool impaired = impairment.latency.count() > 0 || impairment.jitter.count() > 0 || impairment.loss > 0.f
+        || impairment.duplication > 0.f || impairment.reordering > 0.f || impairment.bandwidth > 0;
+    // Impaired bots talk to a proxy per shard instead of the shard itself
+    std::vector<Bousk::uint16> shardPorts;
+    for (unsigned int i = 0; i < shardsCount; ++i)
+        shardPorts.push_back(static_cast<Bousk::uint16>(port + i));
+#if defined(__linux__)
+    std::vector<std::unique_ptr<ImpairmentProxy>> proxies;
+    if (impaired)
+    {
+        for (unsigned int i = 0; i < shardsCount; ++i)
+        {
+            ImpairmentProxy::Parameters proxyParameters;
+            proxyParameters.serverPort = shardPorts[i];
+            proxyParameters.toServer = impairment;
+            proxyParameters.toServer.seed = impairment.seed * 2 * shardsCount + i * 2;
+            proxyParameters.toClients = impairment;
+            proxyParameters.toClients.seed = proxyParameters.toServer.seed + 1;
+            proxies.push_back(std::make_unique<ImpairmentProxy>());
+            if (!proxies.back()->start(proxyParameters))
+            {
+                std::cout << "Impairment proxy " << i << " initialization error" << std::endl;
+                return -3;
+            }
+            shardPorts[i] = proxies.back()->port();
+        }
+    }
+#else
+    if (impaired)
+    {
+        std::cout << "Impairment is only available on Linux" << std::endl;
+        return -3;
+    }
+#endif
+
+    // Spread bots evenly over the server shards, spectators last
+    std::vector<std::unique_ptr<Bot>> bots;
+    bots.reserve(botsCount + spectatorsCount);
+    for (size_t i = 0; i < botsCount + spectatorsCount; ++i)
+    {
+        bots.push_back(std::make_unique<Bot>(static_cast<uint32_t>(i * 2654435761u), policy, i >= botsCount));
+        if (!bots.back()->start(Bousk::Network::Address::Loopback(Bousk::Network::Address::Type::IPv4, shardPorts[i % shardsCount])))
+        {
+            std::cout << "Bot " << i << " initialization error" << std::endl;
+            return -2;
+        }
+    }
+
+    std::cout << botsCount << " bots and " << spectatorsCount << " spectators on " << threadsCount << " threads against ports " << port << " to " << (port + shardsCount - 1) << " for " << duration << "s" << std::endl;
+    std::atomic<bool> running{ true };
+    std::vector<std::thread> threads;
+    std::vector<Bot::Timings> timings(threadsCount);
+    for (unsigned int t = 0; t < threadsCount; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while (running)
+            {
+                for (size_t i = t; i < bots.size(); i += threadsCount)
+                    bots[i]->update(timings[t]);
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(duration));
+    running = false;
+    for (std::thread& thread : threads)
+        thread.join();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    Bot::Statistics total;
+    Bot::Statistics spectators;
+    size_t connected = 0;
+    // Round-trips of the network service pings, relayed by nothing but the server network thread
+    Histogram pingRoundTrip;
+    uint64_t unansweredPings = 0;
+    NetService::ConnectionSample sample;
+    for (size_t i = 0; i < bots.size(); ++i)
+    {
+        const Bot::Statistics& statistics = bots[i]->statistics();
+        connected += statistics.connected ? 1 : 0;
+        if (bots[i]->sampleConnection(sample))
+        {
+            pingRoundTrip.merge(sample.rtt);
+            unansweredPings += sample.unansweredPings();
+        }
+        bots[i]->stop();
+        if (i >= botsCount)
+        {
+            spectators.movesReceived += statistics.movesReceived;
+            spectators.snapshotsReceived += statistics.snapshotsReceived;
+            spectators.resyncs += statistics.resyncs;
+            continue;
+        }
+        total.matchesStarted += statistics.matchesStarted;
+        total.movesSent += statistics.movesSent;
+        total.movesReceived += statistics.movesReceived;
+        total.resyncs += statistics.resyncs;
+        total.reconnections += statistics.reconnections;
+    }
+    std::cout << connected << " bots connected" << std::endl;
+    std::cout << total.matchesStarted << " matches, " << total.movesSent << " moves sent, " << total.movesReceived << " moves received, " << total.resyncs << " resyncs, " << total.reconnections << " reconnections" << std::endl;
+    std::cout << (total.movesSent / elapsed.count()) << " moves/s" << std::endl;
+    Bot::Timings totalTimings;
+    for (const Bot::Timings& threadTimings : timings)
+    {
+        totalTimings.connect.merge(threadTimings.connect);
+        totalTimings.moveRoundTrip.merge(threadTimings.moveRoundTrip);
+        totalTimings.matchDuration.merge(threadTimings.matchDuration);
+    }
+    PrintPercentiles("Connect", totalTimings.connect, "us");
+    PrintPercentiles("Move round-trip", totalTimings.moveRoundTrip, "us");
+    PrintPercentiles("Match duration", totalTimings.matchDuration, "ms");
+    PrintPercentiles("Ping round-trip", pingRoundTrip, "us");
+    std::cout << "  " << unansweredPings << " pings unanswered" << std::endl;
+#if defined(__linux__)
+    if (impaired)
+    {
+        // Datagrams per move : what the reliable channel costs on this link, retransmissions and acknowledgments included
+        Impairment::Statistics toServer;
+        Impairment::Statistics toClients;
+        auto accumulate = [](Impairment::Statistics& total, const Impairment::Statistics& statistics)
+        {
+            total.received += statistics.received;
+            total.dropped += statistics.dropped;
+            total.duplicated += statistics.duplicated;
+            total.reordered += statistics.reordered;
+            total.deliveredBytes += statistics.deliveredBytes;
+        };
+        for (auto& proxy : proxies)
+        {
+            proxy->stop();
+            const ImpairmentProxy::Statistics statistics = proxy->statistics();
+            accumulate(toServer, statistics.toServer);
+            accumulate(toClients, statistics.toClients);
+        }
+        auto print = [&](const char* name, const Impairment::Statistics& statistics)
+        {
+            const double moves = static_cast<double>(std::max<uint64_t>(total.movesSent, 1));
+            std::cout << "  " << name << " : " << statistics.received << " datagrams, " << statistics.dropped << " dropped, " << statistics.duplicated << " duplicated, "
+                << statistics.reordered << " reordered, " << (statistics.received / moves) << " datagrams and " << (statistics.deliveredBytes / moves) << " bytes per move" << std::endl;
+        };
+        print("To server ", toServer);
+        print("To clients", toClients);
+    }
+#endif
+    if (spectatorsCount > 0)
+    {
+        std::cout << "Spectators : " << (spectators.movesReceived / elapsed.count()) << " deltas/s, " << (spectators.snapshotsReceived / elapsed.count()) << " snapshots/s, "
+            << spectators.resyncs << " resyncs" << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
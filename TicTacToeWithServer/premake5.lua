@@ -1,5 +1,9 @@
 require "Libs/Net/NetworkLib/NetworkLib"
 require "TicTacToeWithServer"
+require "Benchmarks"
+require "SelfPlay"
+require "Server"
+require "LoadGenerator"
 
 workspace "TicTacToeWithServer"
 	configurations { "Debug", "Release" }
@@ -8,4 +12,10 @@ workspace "TicTacToeWithServer"
 	location("./tmp/builds/projects/" .. _ACTION)
 		
 CreateNetworkLib("Libs/Net/NetworkLib/", "./tmp/builds/files/" .. _ACTION .. "/%{cfg.buildcfg}")
-CreateTicTacToeWithServer("./", "./builds/%{cfg.buildcfg}")
\ No newline at end of file
+CreateTicTacToeWithServer("./", "./builds/%{cfg.buildcfg}")
+CreateGridBatchBenchmark("./", "./builds/%{cfg.buildcfg}")
+CreateBatchedSocketBenchmark("./", "./builds/%{cfg.buildcfg}")
+CreateProtocolBenchmark("./", "./builds/%{cfg.buildcfg}")
+CreateSelfPlay("./", "./builds/%{cfg.buildcfg}")
+CreateServer("./", "./builds/%{cfg.buildcfg}")
+CreateLoadGenerator("./", "./builds/%{cfg.buildcfg}")
\ No newline at end of file
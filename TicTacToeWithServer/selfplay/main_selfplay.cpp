@@ -0,0 +1,154 @@
+#include <CommandLine.hpp>
+#include <Game.hpp>
+#include <Policy.hpp>
+#include <WorkStealingPool.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Headless bot against bot games, written to a binary file
+// File : "TTTG" magic, uint32 version, uint64 games count, then one uint64 record per game
+// Record : bits [0, 36[ moves as 4 bits case indexes (x * 3 + y) in play order, bits [36, 40[ moves count, bits [40, 42[ winner as Case
+namespace
+{
+    constexpr uint32_t FileVersion = 1;
+    // Games per task : big enough to amortize the task, small enough to balance threads
+    constexpr uint64_t GamesPerTask = 1 << 16;
+
+    uint64_t PlayGame(TicTacToe::IPolicy& xPolicy, TicTacToe::IPolicy& oPolicy)
+    {
+        TicTacToe::Grid grid;
+        TicTacToe::Case player = TicTacToe::Case::X;
+        uint64_t record = 0;
+        unsigned int movesCount = 0;
+        while (!grid.isFinished())
+        {
+            unsigned int x, y;
+            TicTacToe::IPolicy& policy = player == TicTacToe::Case::X ? xPolicy : oPolicy;
+            if (!policy.chooseMove(grid, player, x, y) || !grid.play(x, y, player))
+                break;
+            record |= static_cast<uint64_t>(x * 3 + y) << (4 * movesCount);
+            ++movesCount;
+            player = player == TicTacToe::Case::X ? TicTacToe::Case::O : TicTacToe::Case::X;
+        }
+        record |= static_cast<uint64_t>(movesCount) << 36;
+        record |= static_cast<uint64_t>(grid.winner()) << 40;
+        return record;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t gamesCount = 10000000;
+    unsigned int threadsCount = std::max(1u, std::thread::hardware_concurrency());
+    TicTacToe::PolicyType xPolicyType = TicTacToe::PolicyType::Random;
+    TicTacToe::PolicyType oPolicyType = TicTacToe::PolicyType::Random;
+    std::string outputPath = "games.bin";
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        const size_t separator = arg.find(':');
+        const std::string name = arg.substr(0, separator);
+        const std::string value = separator == std::string::npos ? "" : arg.substr(separator + 1);
+        bool valid = !value.empty();
+        if (name == "-games")
+            valid &= CommandLine::ParseInteger(value, gamesCount, 1);
+        else if (name == "-threads")
+            valid &= CommandLine::ParseInteger(value, threadsCount, 1);
+        else if (name == "-x")
+            valid &= TicTacToe::ParsePolicyType(value, xPolicyType);
+        else if (name == "-o")
+            valid &= TicTacToe::ParsePolicyType(value, oPolicyType);
+        else if (name == "-output")
+            outputPath = value;
+        else
+            valid = false;
+        if (!valid)
+        {
+            std::cout << "Usage : " << argv[0] << " [-games:N] [-threads:N] [-x:random|solver|mcts] [-o:random|solver|mcts] [-output:file]" << std::endl;
+            return -1;
+        }
+    }
+
+    FILE* output = std::fopen(outputPath.c_str(), "wb");
+    if (!output)
+    {
+        std::cout << "Can't open " << outputPath << std::endl;
+        return -2;
+    }
+    const char magic[4] = { 'T', 'T', 'T', 'G' };
+    if (std::fwrite(magic, sizeof(magic), 1, output) != 1
+        || std::fwrite(&FileVersion, sizeof(FileVersion), 1, output) != 1
+        || std::fwrite(&gamesCount, sizeof(gamesCount), 1, output) != 1)
+    {
+        std::cout << "Can't write " << outputPath << std::endl;
+        std::fclose(output);
+        return -3;
+    }
+
+    std::cout << "Playing " << gamesCount << " games, X " << TicTacToe::PolicyTypeName(xPolicyType) << " against O " << TicTacToe::PolicyTypeName(oPolicyType) << " on " << threadsCount << " threads" << std::endl;
+    WorkStealingPool pool(threadsCount);
+    // Policies keep state : one pair per worker, created by the worker itself
+    struct WorkerPolicies
+    {
+        std::unique_ptr<TicTacToe::IPolicy> x;
+        std::unique_ptr<TicTacToe::IPolicy> o;
+        std::vector<uint64_t> records;
+    };
+    std::vector<WorkerPolicies> workers(pool.size());
+    std::mutex outputMutex;
+    // Set by the first failed write : the games left are not played
+    std::atomic<bool> writeFailed{ false };
+    std::array<std::atomic<uint64_t>, 3> results{};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t first = 0; first < gamesCount; first += GamesPerTask)
+    {
+        const uint64_t count = std::min(GamesPerTask, gamesCount - first);
+        pool.push([&, first, count](unsigned int workerIndex)
+        {
+            if (writeFailed)
+                return;
+            WorkerPolicies& worker = workers[workerIndex];
+            if (!worker.x)
+            {
+                worker.x = TicTacToe::CreatePolicy(xPolicyType, 0x9E3779B97F4A7C15ull * (2 * workerIndex + 1));
+                worker.o = TicTacToe::CreatePolicy(oPolicyType, 0x9E3779B97F4A7C15ull * (2 * workerIndex + 2));
+                worker.records.reserve(GamesPerTask);
+            }
+            worker.records.clear();
+            std::array<uint64_t, 3> localResults{};
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const uint64_t record = PlayGame(*worker.x, *worker.o);
+                worker.records.push_back(record);
+                ++localResults[(record >> 40) & 3];
+            }
+            for (size_t i = 0; i < localResults.size(); ++i)
+                results[i] += localResults[i];
+            std::lock_guard<std::mutex> lock(outputMutex);
+            if (std::fwrite(worker.records.data(), sizeof(uint64_t), worker.records.size(), output) != worker.records.size())
+                writeFailed = true;
+        });
+    }
+    pool.wait();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // Buffered records are only written by fclose, which can fail as well
+    if (std::fclose(output) != 0 || writeFailed)
+    {
+        std::cout << "Can't write " << outputPath << std::endl;
+        return -3;
+    }
+
+    std::cout << gamesCount << " games in " << elapsed.count() << "s : " << (gamesCount / elapsed.count()) << " games/s" << std::endl;
+    std::cout << "X wins " << results[static_cast<size_t>(TicTacToe::Case::X)]
+        << ", O wins " << results[static_cast<size_t>(TicTacToe::Case::O)]
+        << ", draws " << results[static_cast<size_t>(TicTacToe::Case::Empty)] << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#if defined(__linux__)
+
+#include <BatchedSocket.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+
+BatchedSocket::~BatchedSocket()
+{
+	release();
+}
+
+bool BatchedSocket::init(const Parameters& parameters)
+{
+	if (mSocket >= 0 || !parameters.receiveBatch || !parameters.sendBatch)
+		return false;
+	mSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (mSocket < 0)
+		return false;
+	sockaddr_in address{};
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(parameters.port);
+	if (bind(mSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+		|| fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL, 0) | O_NONBLOCK) != 0)
+	{
+		release();
+		return false;
+	}
+	mParameters = parameters;
+
+	mReceived.resize(parameters.receiveBatch);
+	mReceiveHeaders.resize(parameters.receiveBatch);
+	mReceiveVectors.resize(parameters.receiveBatch);
+	for (size_t i = 0; i < parameters.receiveBatch; ++i)
+	{
+		mReceiveVectors[i] = iovec{ mReceived[i].data.data(), MaxDatagramSize };
+		mReceiveHeaders[i] = mmsghdr{};
+	}
+	mSendQueue.resize(parameters.sendBatch);
+	mSendHeaders.resize(parameters.sendBatch);
+	mSendVectors.resize(parameters.sendBatch);
+	for (size_t i = 0; i < parameters.sendBatch; ++i)
+	{
+		mSendVectors[i] = iovec{ mSendQueue[i].data.data(), 0 };
+		mSendHeaders[i] = mmsghdr{};
+		mSendHeaders[i].msg_hdr.msg_name = &mSendQueue[i].address;
+		mSendHeaders[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		mSendHeaders[i].msg_hdr.msg_iov = &mSendVectors[i];
+		mSendHeaders[i].msg_hdr.msg_iovlen = 1;
+	}
+	mQueued = 0;
+	return true;
+}
+void BatchedSocket::release()
+{
+	if (mSocket < 0)
+		return;
+	close(mSocket);
+	mSocket = -1;
+}
+uint16_t BatchedSocket::port() const
+{
+	sockaddr_in address{};
+	socklen_t length = sizeof(address);
+	if (mSocket < 0 || getsockname(mSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+		return 0;
+	return ntohs(address.sin_port);
+}
+
+size_t BatchedSocket::receive()
+{
+	if (mSocket < 0)
+		return 0;
+	size_t count = 0;
+	if (mParameters.mode == Mode::Batched)
+	{
+		// recvmmsg overwrites lengths : reset headers before each call
+		for (size_t i = 0; i < mParameters.receiveBatch; ++i)
+		{
+			msghdr& header = mReceiveHeaders[i].msg_hdr;
+			header.msg_name = &mReceived[i].address;
+			header.msg_namelen = sizeof(sockaddr_in);
+			header.msg_iov = &mReceiveVectors[i];
+			header.msg_iovlen = 1;
+		}
+		++mStatistics.receiveCalls;
+		const int result = recvmmsg(mSocket, mReceiveHeaders.data(), static_cast<unsigned int>(mParameters.receiveBatch), MSG_DONTWAIT, nullptr);
+		if (result <= 0)
+			return 0;
+		count = static_cast<size_t>(result);
+		for (size_t i = 0; i < count; ++i)
+			mReceived[i].size = static_cast<uint16_t>(mReceiveHeaders[i].msg_len);
+	}
+	else
+	{
+		for (; count < mParameters.receiveBatch; ++count)
+		{
+			Datagram& datagram = mReceived[count];
+			socklen_t length = sizeof(sockaddr_in);
+			++mStatistics.receiveCalls;
+			const ssize_t result = recvfrom(mSocket, datagram.data.data(), MaxDatagramSize, MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&datagram.address), &length);
+			if (result < 0)
+				break;
+			datagram.size = static_cast<uint16_t>(result);
+		}
+	}
+	mStatistics.received += count;
+	return count;
+}
+
+bool BatchedSocket::queue(const sockaddr_in& target, const uint8_t* data, size_t size)
+{
+	if (mSocket < 0 || size > MaxDatagramSize)
+		return false;
+	if (mQueued == mParameters.sendBatch)
+		flush();
+	Datagram& datagram = mSendQueue[mQueued];
+	datagram.address = target;
+	datagram.size = static_cast<uint16_t>(size);
+	memcpy(datagram.data.data(), data, size);
+	mSendVectors[mQueued].iov_len = size;
+	++mQueued;
+	return true;
+}
+size_t BatchedSocket::flush()
+{
+	size_t sent = 0;
+	if (mParameters.mode == Mode::Batched)
+	{
+		while (sent < mQueued)
+		{
+			++mStatistics.sendCalls;
+			const int result = sendmmsg(mSocket, mSendHeaders.data() + sent, static_cast<unsigned int>(mQueued - sent), MSG_DONTWAIT);
+			if (result <= 0)
+				break;
+			sent += static_cast<size_t>(result);
+		}
+	}
+	else
+	{
+		for (; sent < mQueued; ++sent)
+		{
+			const Datagram& datagram = mSendQueue[sent];
+			++mStatistics.sendCalls;
+			if (sendto(mSocket, datagram.data.data(), datagram.size, MSG_DONTWAIT, reinterpret_cast<const sockaddr*>(&datagram.address), sizeof(sockaddr_in)) < 0)
+				break;
+		}
+	}
+	// UDP gives no guarantee : datagrams the kernel refused are dropped rather than retried
+	mStatistics.sent += sent;
+	mStatistics.dropped += mQueued - sent;
+	mQueued = 0;
+	return sent;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+// Linux only : relies on recvmmsg and sendmmsg
+#if defined(__linux__)
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Non blocking IPv4 UDP socket moving datagrams in batches
+// Batched mode drains up to receiveBatch datagrams per recvmmsg and sends queued datagrams sendBatch at a time with sendmmsg
+// PerDatagram mode does the same work with one recvfrom or sendto per datagram, as a reference
+class BatchedSocket
+{
+public:
+	enum class Mode
+	{
+		PerDatagram,
+		Batched,
+	};
+	struct Parameters
+	{
+		Mode mode{ Mode::Batched };
+		uint16_t port{ 0 };
+		size_t receiveBatch{ 64 };
+		size_t sendBatch{ 64 };
+	};
+	static constexpr size_t MaxDatagramSize = 1400;
+	struct Datagram
+	{
+		sockaddr_in address;
+		uint16_t size;
+		std::array<uint8_t, MaxDatagramSize> data;
+	};
+	struct Statistics
+	{
+		uint64_t receiveCalls{ 0 };
+		uint64_t sendCalls{ 0 };
+		uint64_t received{ 0 };
+		uint64_t sent{ 0 };
+		uint64_t dropped{ 0 };
+	};
+public:
+	BatchedSocket() = default;
+	~BatchedSocket();
+	BatchedSocket(const BatchedSocket&) = delete;
+	BatchedSocket& operator=(const BatchedSocket&) = delete;
+
+	bool init(const Parameters& parameters);
+	void release();
+	uint16_t port() const;
+
+	// Read at most receiveBatch pending datagrams into received(). Return how many, 0 once the socket is drained.
+	size_t receive();
+	const Datagram& received(size_t index) const { return mReceived[index]; }
+
+	// Copy datagram to the send queue. A full queue is flushed first.
+	bool queue(const sockaddr_in& target, const uint8_t* data, size_t size);
+	// Send every queued datagram. Return how many were sent.
+	size_t flush();
+
+	const Statistics& statistics() const { return mStatistics; }
+
+private:
+	int mSocket{ -1 };
+	Parameters mParameters;
+	std::vector<Datagram> mReceived;
+	std::vector<Datagram> mSendQueue;
+	size_t mQueued{ 0 };
+	// recvmmsg and sendmmsg headers, pointing into the datagram buffers once and for all
+	std::vector<mmsghdr> mReceiveHeaders;
+	std::vector<iovec> mReceiveVectors;
+	std::vector<mmsghdr> mSendHeaders;
+	std::vector<iovec> mSendVectors;
+	Statistics mStatistics;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,560 @@
+#include <MatchServer.hpp>
+
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	TicTacToe::Case Opponent(TicTacToe::Case symbol)
+	{
+		return symbol == TicTacToe::Case::X ? TicTacToe::Case::O : TicTacToe::Case::X;
+	}
+	// SplitMix64
+	uint64_t NextKey(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	// Order doesn't matter : move the last one in its place
+	void SwapRemove(std::vector<uint32_t>& values, uint32_t value)
+	{
+		const auto it = std::find(values.begin(), values.end(), value);
+		if (it == values.end())
+			return;
+		*it = values.back();
+		values.pop_back();
+	}
+}
+
+MatchServer::MatchServer(NetService& netService, size_t maxPlayers)
+	: mNetService(netService)
+	, mAddresses(maxPlayers)
+	, mPlayers(maxPlayers)
+	, mKeys(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()))
+	, mMatches(maxPlayers / 2)
+	, mMatchmaking(maxPlayers, Matchmaking::Parameters())
+{
+	mAbsentPlayers.reserve(maxPlayers);
+}
+size_t MatchServer::MemoryPerMatch()
+{
+	return SessionPool<Match>::MemoryPerObject() + 2 * (SessionPool<Player>::MemoryPerObject() + AddressTable::MemoryPerEntry() + sizeof(uint32_t));
+}
+size_t MatchServer::memory() const
+{
+	return mPlayers.memory() + mMatches.memory() + mAddresses.memory() + mAbsentPlayers.capacity() * sizeof(uint32_t);
+}
+
+void MatchServer::update()
+{
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < mAbsentPlayers.size();)
+	{
+		if (now < mPlayers[mAbsentPlayers[i]].absentUntil)
+			++i;
+		else
+			// Leaves the list, another one takes index i
+			forfeitSeat(mAbsentPlayers[i]);
+	}
+
+	mPairs.clear();
+	mMatchmaking.update(Matchmaking::Clock::now(), mPairs);
+	for (const Matchmaking::Pair& pair : mPairs)
+		startMatch(pair.first, pair.second);
+	mStatistics.waitingPlayers = mMatchmaking.waitingCount();
+
+	// Only the featured match has spectators
+	Match* const featured = mMatches.get(mFeatured);
+	if (featured && featured->spectatorsBehind && now >= mNextCatchUp)
+	{
+		featured->spectatorsBehind = false;
+		mNextCatchUp = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.f / SpectatorUpdatesPerSecond));
+		for (uint32_t spectatorIndex = featured->firstSpectator; spectatorIndex != None; spectatorIndex = mPlayers[spectatorIndex].nextSpectator)
+		{
+			if (!mPlayers[spectatorIndex].upToDate)
+				catchUpSpectator(*featured, mPlayers[spectatorIndex], now);
+		}
+	}
+}
+
+bool MatchServer::onIncomingConnection(const Bousk::Network::Messages::IncomingConnection&)
+{
+	// Seats kept for absent players make room for connected ones
+	return !mPlayers.isFull() || !mAbsentPlayers.empty();
+}
+void MatchServer::onConnectionResult(const Bousk::Network::Messages::Connection& connection)
+{
+	if (connection.result != Bousk::Network::Messages::Connection::Result::Success)
+		return;
+	if (findPlayer(connection.emitter()) != None)
+		return;
+	// Player is queued once its Hello tells it speaks our protocol
+	addPlayer(connection.emitter());
+}
+void MatchServer::onDisconnection(const Bousk::Network::Messages::Disconnection& disconnection)
+{
+	const uint32_t playerIndex = findPlayer(disconnection.emitter());
+	if (playerIndex == None)
+		return;
+	if (mPlayers[playerIndex].spectator)
+	{
+		unlinkSpectator(playerIndex);
+		--mStatistics.spectators;
+		removePlayer(playerIndex);
+		return;
+	}
+	mMatchmaking.leave(playerIndex);
+	// The match goes on without it for a while : the opponent wins by forfeit only if it doesn't rejoin in time
+	if (mPlayers[playerIndex].match.isValid())
+	{
+		leaveSeat(playerIndex);
+		return;
+	}
+	removePlayer(playerIndex);
+}
+void MatchServer::onDataReceived(const Bousk::Network::Messages::UserData& userData)
+{
+	++mStatistics.received;
+	uint32_t playerIndex = findPlayer(userData.emitter());
+	if (playerIndex == None)
+		return;
+	TicTacToe::Net::PacketReader reader(userData.data.data(), userData.data.size());
+	TicTacToe::Net::MessageType type;
+	while (reader.next(type))
+	{
+		bool valid = false;
+		switch (type)
+		{
+			case TicTacToe::Net::MessageType::Play:
+			{
+				TicTacToe::Net::Play play;
+				valid = reader.read(play);
+				if (valid)
+					onPlay(playerIndex, play);
+			} break;
+			case TicTacToe::Net::MessageType::Hello:
+			{
+				TicTacToe::Net::Hello hello;
+				valid = reader.read(hello);
+				if (valid)
+					onHello(playerIndex, hello);
+			} break;
+			case TicTacToe::Net::MessageType::Resync:
+			{
+				TicTacToe::Net::Resync resync;
+				valid = reader.read(resync);
+				if (valid)
+					onResync(playerIndex);
+			} break;
+			case TicTacToe::Net::MessageType::Spectate:
+			{
+				TicTacToe::Net::Spectate spectate;
+				valid = reader.read(spectate);
+				if (valid)
+					onSpectate(playerIndex, spectate);
+			} break;
+			case TicTacToe::Net::MessageType::Rejoin:
+			{
+				TicTacToe::Net::Rejoin rejoin;
+				valid = reader.read(rejoin);
+				if (valid)
+					playerIndex = onRejoin(playerIndex, rejoin);
+			} break;
+			// Only the server starts matches and sends their state
+			case TicTacToe::Net::MessageType::Start:
+			case TicTacToe::Net::MessageType::Seat:
+			case TicTacToe::Net::MessageType::Snapshot:
+			case TicTacToe::Net::MessageType::Delta:
+			// Answered by NetService in datagrams of their own
+			case TicTacToe::Net::MessageType::Ping:
+			case TicTacToe::Net::MessageType::Pong:
+				break;
+		}
+		// Can't find the next message after an invalid one : drop the rest of the packet
+		if (!valid)
+		{
+			++mStatistics.rejectedMessages;
+			return;
+		}
+	}
+}
+
+void MatchServer::queuePlayer(uint32_t playerIndex)
+{
+	const uint32_t opponentIndex = mMatchmaking.join(playerIndex, mPlayers[playerIndex].rating, Matchmaking::Clock::now());
+	if (opponentIndex != None)
+		startMatch(opponentIndex, playerIndex);
+	mStatistics.waitingPlayers = mMatchmaking.waitingCount();
+}
+void MatchServer::requeuePlayer(uint32_t playerIndex)
+{
+	if (mPlayers[playerIndex].absent)
+		forgetAbsent(playerIndex);
+	else
+		queuePlayer(playerIndex);
+}
+void MatchServer::startMatch(uint32_t firstPlayer, uint32_t secondPlayer)
+{
+	const MatchHandle matchHandle = mMatches.create();
+	if (!matchHandle.isValid())
+		return;
+	Match& match = *mMatches.get(matchHandle);
+	match.players = { firstPlayer, secondPlayer };
+	match.started = std::chrono::steady_clock::now();
+	if (!mMatches.get(mFeatured))
+	{
+		// Previous featured match is over : its spectators waiting for the next one watch this one, from its empty board
+		mFeatured = matchHandle;
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		while (mIdleSpectators != None)
+		{
+			const uint32_t spectatorIndex = mIdleSpectators;
+			unlinkSpectator(spectatorIndex);
+			linkSpectator(spectatorIndex, matchHandle);
+			catchUpSpectator(match, mPlayers[spectatorIndex], now);
+		}
+	}
+	// First player to connect plays X, and X plays first
+	const std::array<TicTacToe::Case, 2> symbols{ TicTacToe::Case::X, TicTacToe::Case::O };
+	for (size_t i = 0; i < 2; ++i)
+	{
+		Player& player = mPlayers[match.players[i]];
+		player.match = matchHandle;
+		player.symbol = symbols[i];
+		player.key = static_cast<uint32_t>(NextKey(mKeys));
+		TicTacToe::Net::Start start;
+		start.symbol = symbols[i];
+		send(player, start);
+		TicTacToe::Net::Seat seat;
+		seat.player = match.players[i];
+		seat.generation = mPlayers.handle(match.players[i]).generation;
+		seat.key = player.key;
+		send(player, seat);
+	}
+	++mStatistics.matchesStarted;
+	++mStatistics.activeMatches;
+}
+std::array<uint32_t, 2> MatchServer::endMatch(MatchHandle matchHandle, TicTacToe::Case winner)
+{
+	Match& match = *mMatches.get(matchHandle);
+	const std::array<uint32_t, 2> players = match.players;
+	updateRatings(mPlayers[players[0]], mPlayers[players[1]], winner);
+	for (uint32_t playerIndex : players)
+	{
+		mPlayers[playerIndex].match = MatchHandle();
+		mPlayers[playerIndex].symbol = TicTacToe::Case::Empty;
+	}
+	while (match.firstSpectator != None)
+	{
+		const uint32_t spectatorIndex = match.firstSpectator;
+		// Last chance to see the final board, whatever their rate
+		if (!mPlayers[spectatorIndex].upToDate)
+			sendCatchUp(match, mPlayers[spectatorIndex]);
+		unlinkSpectator(spectatorIndex);
+		linkSpectator(spectatorIndex, MatchHandle());
+	}
+	mMatchDuration.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - match.started).count()));
+	mMatches.destroy(matchHandle);
+	++mStatistics.matchesFinished;
+	--mStatistics.activeMatches;
+	return players;
+}
+void MatchServer::onHello(uint32_t playerIndex, const TicTacToe::Net::Hello& hello)
+{
+	Player& player = mPlayers[playerIndex];
+	if (player.greeted)
+		return;
+	if (hello.version != TicTacToe::Net::ProtocolVersion)
+	{
+		++mStatistics.incompatibleClients;
+		return;
+	}
+	player.greeted = true;
+	queuePlayer(playerIndex);
+}
+void MatchServer::onPlay(uint32_t playerIndex, const TicTacToe::Net::Play& play)
+{
+	const Player& player = mPlayers[playerIndex];
+	Match* const matchPointer = mMatches.get(player.match);
+	if (!matchPointer)
+	{
+		++mStatistics.rejectedMoves;
+		return;
+	}
+	Match& match = *matchPointer;
+	if (match.turn != player.symbol || !match.grid.play(play.x, play.y, player.symbol))
+	{
+		++mStatistics.rejectedMoves;
+		return;
+	}
+	++mStatistics.moves;
+	match.turn = Opponent(match.turn);
+	const uint32_t opponentIndex = match.players[0] == playerIndex ? match.players[1] : match.players[0];
+	TicTacToe::Net::Delta delta;
+	delta.sequence = static_cast<uint8_t>(match.grid.playedCount());
+	delta.x = play.x;
+	delta.y = play.y;
+	send(mPlayers[opponentIndex], delta);
+	broadcast(match, delta);
+	if (match.grid.isFinished())
+	{
+		const std::array<uint32_t, 2> players = endMatch(player.match, match.grid.winner());
+		requeuePlayer(players[0]);
+		requeuePlayer(players[1]);
+	}
+}
+void MatchServer::onResync(uint32_t playerIndex)
+{
+	Player& player = mPlayers[playerIndex];
+	Match* const match = mMatches.get(player.match);
+	if (!match)
+		return;
+	++mStatistics.resyncs;
+	// Spectators get the shared snapshot, within their rate
+	if (player.spectator)
+	{
+		player.upToDate = false;
+		catchUpSpectator(*match, player, std::chrono::steady_clock::now());
+		return;
+	}
+	send(player, TicTacToe::Net::Snapshot::Of(match->grid));
+}
+uint32_t MatchServer::onRejoin(uint32_t playerIndex, const TicTacToe::Net::Rejoin& rejoin)
+{
+	Player& player = mPlayers[playerIndex];
+	if (player.greeted)
+		return playerIndex;
+	if (rejoin.version != TicTacToe::Net::ProtocolVersion)
+	{
+		++mStatistics.incompatibleClients;
+		return playerIndex;
+	}
+	Player* const seat = mPlayers.get({ rejoin.seat.player, rejoin.seat.generation });
+	if (!seat || !seat->absent || seat->key != rejoin.seat.key)
+	{
+		// Match over, grace over, or no such seat : on to the next match
+		player.greeted = true;
+		queuePlayer(playerIndex);
+		return playerIndex;
+	}
+	// The kept seat takes over the new connection
+	const Bousk::Network::Address address = player.address;
+	removePlayer(playerIndex);
+	const uint32_t seatIndex = rejoin.seat.player;
+	SwapRemove(mAbsentPlayers, seatIndex);
+	mStatistics.absentPlayers = mAbsentPlayers.size();
+	seat->absent = false;
+	seat->address = address;
+	seat->outgoing = nullptr;
+	mAddresses.insert(address, seatIndex);
+	++mStatistics.connectedPlayers;
+	++mStatistics.rejoins;
+	send(*seat, TicTacToe::Net::Snapshot::Of(mMatches.get(seat->match)->grid));
+	return seatIndex;
+}
+void MatchServer::onSpectate(uint32_t playerIndex, const TicTacToe::Net::Spectate& spectate)
+{
+	Player& player = mPlayers[playerIndex];
+	if (player.greeted)
+		return;
+	if (spectate.version != TicTacToe::Net::ProtocolVersion)
+	{
+		++mStatistics.incompatibleClients;
+		return;
+	}
+	player.greeted = true;
+	player.spectator = true;
+	player.credits = SpectatorBurst;
+	player.lastRefill = std::chrono::steady_clock::now();
+	// No live featured match : wait for the next one
+	linkSpectator(playerIndex, mFeatured);
+	if (Match* const match = mMatches.get(player.match))
+		catchUpSpectator(*match, player, player.lastRefill);
+	++mStatistics.spectators;
+}
+void MatchServer::broadcast(Match& match, const TicTacToe::Net::Delta& delta)
+{
+	if (match.firstSpectator == None)
+		return;
+	if (match.deltas && match.broadcastTick == mNetService.tick())
+	{
+		// Spectators already have their packet of this tick : complete it
+		match.deltas->writer().write(delta);
+		if (match.catchUp)
+			match.catchUp->writer().write(delta);
+		return;
+	}
+	match.deltas = &mNetService.acquireSharedBuffer();
+	match.deltas->writer().write(delta);
+	match.catchUp = nullptr;
+	match.broadcastTick = mNetService.tick();
+	++mStatistics.broadcastPackets;
+
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (uint32_t spectatorIndex = match.firstSpectator; spectatorIndex != None; spectatorIndex = mPlayers[spectatorIndex].nextSpectator)
+	{
+		Player& spectator = mPlayers[spectatorIndex];
+		if (!consumeCredit(spectator, now))
+		{
+			// Nothing queued for it : it will catch up from a snapshot instead of all the deltas it missed
+			spectator.upToDate = false;
+			match.spectatorsBehind = true;
+			++mStatistics.coalescedUpdates;
+			continue;
+		}
+		if (!spectator.upToDate)
+		{
+			sendCatchUp(match, spectator);
+			continue;
+		}
+		mNetService.sendTo(spectator.address, *match.deltas);
+		++mStatistics.spectatorUpdates;
+	}
+}
+void MatchServer::sendCatchUp(Match& match, Player& spectator)
+{
+	if (!match.catchUp || match.broadcastTick != mNetService.tick())
+	{
+		// Packets of a previous tick are gone : deltas of this one start a new packet
+		if (match.broadcastTick != mNetService.tick())
+			match.deltas = nullptr;
+		// Snapshot already holds the deltas of this tick so far, the following ones are appended to it
+		match.catchUp = &mNetService.acquireSharedBuffer();
+		match.catchUp->writer().write(TicTacToe::Net::Snapshot::Of(match.grid));
+		match.broadcastTick = mNetService.tick();
+		++mStatistics.broadcastPackets;
+	}
+	mNetService.sendTo(spectator.address, *match.catchUp);
+	spectator.upToDate = true;
+	++mStatistics.spectatorUpdates;
+}
+void MatchServer::catchUpSpectator(Match& match, Player& spectator, std::chrono::steady_clock::time_point now)
+{
+	if (consumeCredit(spectator, now))
+		sendCatchUp(match, spectator);
+	else
+		match.spectatorsBehind = true;
+}
+bool MatchServer::consumeCredit(Player& spectator, std::chrono::steady_clock::time_point now)
+{
+	const float elapsed = std::chrono::duration<float>(now - spectator.lastRefill).count();
+	spectator.credits = std::min(SpectatorBurst, spectator.credits + elapsed * SpectatorUpdatesPerSecond);
+	spectator.lastRefill = now;
+	if (spectator.credits < 1.f)
+		return false;
+	spectator.credits -= 1.f;
+	return true;
+}
+void MatchServer::linkSpectator(uint32_t spectatorIndex, MatchHandle matchHandle)
+{
+	Player& spectator = mPlayers[spectatorIndex];
+	Match* const match = mMatches.get(matchHandle);
+	uint32_t& head = match ? match->firstSpectator : mIdleSpectators;
+	spectator.match = match ? matchHandle : MatchHandle();
+	spectator.upToDate = false;
+	spectator.previousSpectator = None;
+	spectator.nextSpectator = head;
+	if (head != None)
+		mPlayers[head].previousSpectator = spectatorIndex;
+	head = spectatorIndex;
+}
+void MatchServer::unlinkSpectator(uint32_t spectatorIndex)
+{
+	Player& spectator = mPlayers[spectatorIndex];
+	if (spectator.previousSpectator != None)
+	{
+		mPlayers[spectator.previousSpectator].nextSpectator = spectator.nextSpectator;
+	}
+	else
+	{
+		Match* const match = mMatches.get(spectator.match);
+		(match ? match->firstSpectator : mIdleSpectators) = spectator.nextSpectator;
+	}
+	if (spectator.nextSpectator != None)
+		mPlayers[spectator.nextSpectator].previousSpectator = spectator.previousSpectator;
+	spectator.previousSpectator = None;
+	spectator.nextSpectator = None;
+}
+void MatchServer::updateRatings(Player& first, Player& second, TicTacToe::Case winner)
+{
+	// Elo, with a K factor of 32
+	constexpr double K = 32.;
+	const double expected = 1. / (1. + std::pow(10., (static_cast<double>(second.rating) - first.rating) / 400.));
+	const double score = winner == first.symbol ? 1. : (winner == second.symbol ? 0. : 0.5);
+	const double delta = K * (score - expected);
+	first.rating = static_cast<uint16_t>(std::lround(std::clamp(first.rating + delta, 0., 65535.)));
+	second.rating = static_cast<uint16_t>(std::lround(std::clamp(second.rating - delta, 0., 65535.)));
+}
+template<class Message>
+void MatchServer::send(Player& player, const Message& message)
+{
+	static_assert(Message::DeliveryMode == TicTacToe::Net::Delivery::Reliable, "Player packets go on the reliable channel");
+	// Absent players get the board when they rejoin
+	if (player.absent)
+		return;
+	if (player.outgoing && player.outgoingTick == mNetService.tick() && player.outgoing->writer().write(message))
+		return;
+	// No packet toward the player this tick yet, or it's full
+	player.outgoing = &mNetService.acquireSendBuffer(player.address);
+	player.outgoingTick = mNetService.tick();
+	player.outgoing->writer().write(message);
+}
+
+uint32_t MatchServer::findPlayer(const Bousk::Network::Address& address) const
+{
+	return mAddresses.find(address, [this](uint32_t playerIndex) -> const Bousk::Network::Address& { return mPlayers[playerIndex].address; });
+}
+uint32_t MatchServer::addPlayer(const Bousk::Network::Address& address)
+{
+	if (mPlayers.isFull() && !mAbsentPlayers.empty())
+	{
+		// The one absent for the longest time goes
+		const auto oldest = std::min_element(mAbsentPlayers.begin(), mAbsentPlayers.end(), [this](uint32_t first, uint32_t second) { return mPlayers[first].absentUntil < mPlayers[second].absentUntil; });
+		forfeitSeat(*oldest);
+	}
+	const SessionPool<Player>::Handle playerHandle = mPlayers.create();
+	if (!playerHandle.isValid())
+		return None;
+	const uint32_t playerIndex = playerHandle.index;
+	mPlayers[playerIndex].address = address;
+
+	mAddresses.insert(address, playerIndex);
+	++mStatistics.connectedPlayers;
+	return playerIndex;
+}
+void MatchServer::removePlayer(uint32_t playerIndex)
+{
+	mAddresses.erase(mPlayers[playerIndex].address, playerIndex);
+
+	mPlayers.destroy(mPlayers.handle(playerIndex));
+	--mStatistics.connectedPlayers;
+}
+void MatchServer::leaveSeat(uint32_t playerIndex)
+{
+	Player& player = mPlayers[playerIndex];
+	// Its address may come back as another client
+	mAddresses.erase(player.address, playerIndex);
+	--mStatistics.connectedPlayers;
+	player.absent = true;
+	player.absentUntil = std::chrono::steady_clock::now() + RejoinGrace;
+	player.outgoing = nullptr;
+	mAbsentPlayers.push_back(playerIndex);
+	mStatistics.absentPlayers = mAbsentPlayers.size();
+}
+void MatchServer::forfeitSeat(uint32_t playerIndex)
+{
+	const Player& player = mPlayers[playerIndex];
+	// Both players are forgotten if absent
+	const std::array<uint32_t, 2> players = endMatch(player.match, Opponent(player.symbol));
+	requeuePlayer(players[0]);
+	requeuePlayer(players[1]);
+}
+void MatchServer::forgetAbsent(uint32_t playerIndex)
+{
+	SwapRemove(mAbsentPlayers, playerIndex);
+	mStatistics.absentPlayers = mAbsentPlayers.size();
+	mPlayers.destroy(mPlayers.handle(playerIndex));
+}
\ No newline at end of file
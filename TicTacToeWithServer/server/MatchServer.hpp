@@ -0,0 +1,178 @@
+#pragma once
+
+#include <AddressTable.hpp>
+#include <Game.hpp>
+#include <Matchmaking.hpp>
+#include <Net.hpp>
+#include <NetService.hpp>
+#include <SessionPool.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Authoritative server hosting many matches on a single NetService
+// Pairs connected players of close ratings, validates every move against its own Grid and relays it to the opponent as a sequenced delta
+// A client missing a delta asks for a Resync and gets the whole board back in a snapshot
+// A player whose connection drops keeps its seat for RejoinGrace : reconnecting with Rejoin, it gets the board back in a snapshot
+// Spectators watch the featured match : each update is encoded once per tick and queued by reference to all of them
+// Once a match is over, ratings are updated and its players are queued again for the next one
+// Players and matches live in session pools and players are found by address in a flat open addressing table :
+// connections and matches come and go without heap allocation
+class MatchServer : public NetService::IListener
+{
+public:
+	struct Statistics
+	{
+		size_t connectedPlayers{ 0 };
+		size_t activeMatches{ 0 };
+		size_t waitingPlayers{ 0 };
+		uint64_t matchesStarted{ 0 };
+		uint64_t matchesFinished{ 0 };
+		uint64_t received{ 0 };
+		uint64_t moves{ 0 };
+		uint64_t rejectedMoves{ 0 };
+		// Messages which couldn't be decoded, or not expected from a client
+		uint64_t rejectedMessages{ 0 };
+		uint64_t incompatibleClients{ 0 };
+		// Snapshots sent to clients which missed a delta
+		uint64_t resyncs{ 0 };
+		// Players disconnected during their match whose seat is kept, and those who took it back
+		size_t absentPlayers{ 0 };
+		uint64_t rejoins{ 0 };
+		size_t spectators{ 0 };
+		// Packets encoded for spectators, and queued to them
+		uint64_t broadcastPackets{ 0 };
+		uint64_t spectatorUpdates{ 0 };
+		// Updates not sent to spectators above their rate : they get a snapshot once they have credit again
+		uint64_t coalescedUpdates{ 0 };
+	};
+public:
+	MatchServer(NetService& netService, size_t maxPlayers);
+	~MatchServer() = default;
+
+	// Start matches found by the matchmaking since last update, and send the board to spectators behind once they have credit
+	void update();
+
+	const Statistics& statistics() const { return mStatistics; }
+	const Matchmaking& matchmaking() const { return mMatchmaking; }
+	// Milliseconds from start to end of each match
+	const Histogram& matchDuration() const { return mMatchDuration; }
+	size_t maxPlayers() const { return mPlayers.capacity(); }
+	// Server memory used by a live match : the match and its 2 players, with their address table and absent list slots
+	static size_t MemoryPerMatch();
+	// Memory currently held by the pools and tables, bounded by maxPlayers
+	size_t memory() const;
+
+private:
+	bool onIncomingConnection(const Bousk::Network::Messages::IncomingConnection& incomingConnection) override;
+	void onConnectionResult(const Bousk::Network::Messages::Connection& connection) override;
+	void onDisconnection(const Bousk::Network::Messages::Disconnection& disconnection) override;
+	void onDataReceived(const Bousk::Network::Messages::UserData& userData) override;
+
+	static constexpr uint32_t None = UINT32_MAX;
+	static constexpr uint16_t InitialRating = 1500;
+	// How long the seat of a player disconnected during its match is kept before it forfeits
+	static constexpr std::chrono::seconds RejoinGrace{ 10 };
+	// Spectators backpressure : updates per second each one gets, and how many it can get in a row
+	static constexpr float SpectatorUpdatesPerSecond = 30.f;
+	static constexpr float SpectatorBurst = 4.f;
+	struct Match;
+	using MatchHandle = SessionPool<Match>::Handle;
+	struct Player
+	{
+		Bousk::Network::Address address;
+		MatchHandle match;
+		TicTacToe::Case symbol{ TicTacToe::Case::Empty };
+		uint16_t rating{ InitialRating };
+		// Given in its Seat with each Start, checked on Rejoin
+		uint32_t key{ 0 };
+		// Disconnected during its match : out of the address table, nothing is sent to it
+		bool absent{ false };
+		std::chrono::steady_clock::time_point absentUntil;
+		// Packet toward the player during tick outgoingTick : messages of a tick share one datagram
+		NetService::SendBuffer* outgoing{ nullptr };
+		uint64_t outgoingTick{ 0 };
+		// Hello, or Spectate, received with the right protocol version
+		bool greeted{ false };
+		// A spectator's match is the one it watches. It's linked in the spectators of that match, or the idle ones.
+		bool spectator{ false };
+		bool upToDate{ false };
+		uint32_t previousSpectator{ None };
+		uint32_t nextSpectator{ None };
+		float credits{ 0.f };
+		std::chrono::steady_clock::time_point lastRefill;
+	};
+	struct Match
+	{
+		TicTacToe::Grid grid;
+		// A match ends before its absent players are forgotten : indexes of a live match always point to live players
+		std::array<uint32_t, 2> players{ None, None };
+		TicTacToe::Case turn{ TicTacToe::Case::X };
+		std::chrono::steady_clock::time_point started;
+		uint32_t firstSpectator{ None };
+		// Some spectators are behind and had no credit to catch up
+		bool spectatorsBehind{ false };
+		// Spectators packets of tick broadcastTick : deltas for the spectators up to date, a snapshot and the same deltas for the others
+		NetService::SendBuffer* deltas{ nullptr };
+		NetService::SendBuffer* catchUp{ nullptr };
+		uint64_t broadcastTick{ 0 };
+	};
+
+	void queuePlayer(uint32_t playerIndex);
+	void startMatch(uint32_t firstPlayer, uint32_t secondPlayer);
+	// Update ratings and return the players of the match, now free to be queued again
+	std::array<uint32_t, 2> endMatch(MatchHandle matchHandle, TicTacToe::Case winner);
+	// Queue a player whose match is over, or forget it if it left during the match
+	void requeuePlayer(uint32_t playerIndex);
+	void updateRatings(Player& first, Player& second, TicTacToe::Case winner);
+	void onHello(uint32_t playerIndex, const TicTacToe::Net::Hello& hello);
+	void onPlay(uint32_t playerIndex, const TicTacToe::Net::Play& play);
+	void onResync(uint32_t playerIndex);
+	// Return the index of the player from now on : its kept seat if it takes it back
+	uint32_t onRejoin(uint32_t playerIndex, const TicTacToe::Net::Rejoin& rejoin);
+	void onSpectate(uint32_t playerIndex, const TicTacToe::Net::Spectate& spectate);
+	// Send the delta of a move to the spectators of its match
+	void broadcast(Match& match, const TicTacToe::Net::Delta& delta);
+	// Send the board, and the deltas following it this tick, to a spectator behind. It's then up to date.
+	void sendCatchUp(Match& match, Player& spectator);
+	// Send the board right away within the spectator rate, or once it has credit again
+	void catchUpSpectator(Match& match, Player& spectator, std::chrono::steady_clock::time_point now);
+	// Take a token from the spectator bucket. Return false if it's empty.
+	bool consumeCredit(Player& spectator, std::chrono::steady_clock::time_point now);
+	// Spectators lists, of a match or the idle one when match is invalid
+	void linkSpectator(uint32_t spectatorIndex, MatchHandle match);
+	void unlinkSpectator(uint32_t spectatorIndex);
+	template<class Message>
+	void send(Player& player, const Message& message);
+
+	// Address table
+	uint32_t findPlayer(const Bousk::Network::Address& address) const;
+	uint32_t addPlayer(const Bousk::Network::Address& address);
+	void removePlayer(uint32_t playerIndex);
+	// Keep the seat of a player disconnected during its match, until it rejoins or the grace is over
+	void leaveSeat(uint32_t playerIndex);
+	// End the match of an absent player, won by its opponent
+	void forfeitSeat(uint32_t playerIndex);
+	void forgetAbsent(uint32_t playerIndex);
+
+private:
+	NetService& mNetService;
+	// Player index per address
+	AddressTable mAddresses;
+	SessionPool<Player> mPlayers;
+	// Players with a seat kept, reserved for all of them
+	std::vector<uint32_t> mAbsentPlayers;
+	uint64_t mKeys;
+	SessionPool<Match> mMatches;
+	Matchmaking mMatchmaking;
+	std::vector<Matchmaking::Pair> mPairs;
+	// Match watched by spectators, and those waiting for the next one to start
+	MatchHandle mFeatured;
+	uint32_t mIdleSpectators{ None };
+	// Spectators behind are checked once per credit refill, not every update
+	std::chrono::steady_clock::time_point mNextCatchUp;
+	Statistics mStatistics;
+	Histogram mMatchDuration;
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <Matchmaking.hpp>
+
+Matchmaking::Matchmaking(size_t maxPlayers, const Parameters& parameters)
+	: mParameters(parameters)
+	, mBuckets(parameters.maxRating / parameters.bucketWidth + 1)
+	, mBucketOf(maxPlayers, None)
+{}
+
+uint32_t Matchmaking::join(uint32_t player, uint16_t rating, Clock::time_point now)
+{
+	mQueueDepth.add(mOccupied.size());
+	const uint32_t bucket = bucketOf(rating);
+	if (mBuckets[bucket].player != None)
+	{
+		mTimeToMatch.add(0);
+		return take(bucket, now);
+	}
+	wait(bucket, player, now);
+	return None;
+}
+void Matchmaking::leave(uint32_t player)
+{
+	const uint32_t bucket = mBucketOf[player];
+	if (bucket == None)
+		return;
+	// Pending widenings of the player become stale with its ticket
+	mBuckets[bucket] = Ticket();
+	mOccupied.erase(bucket);
+	mBucketOf[player] = None;
+}
+void Matchmaking::update(Clock::time_point now, std::vector<Pair>& pairs)
+{
+	for (size_t budget = mParameters.updateBudget; budget && !mWidenings.empty() && mWidenings.front().due <= now; --budget)
+	{
+		const Widening widening = mWidenings.front();
+		mWidenings.pop_front();
+		if (mBuckets[widening.bucket].sequence != widening.sequence)
+			continue;
+		const uint32_t opponentBucket = findOpponentBucket(widening.bucket, widening.window);
+		if (opponentBucket != None)
+		{
+			const bool waitedLonger = mBuckets[widening.bucket].joined <= mBuckets[opponentBucket].joined;
+			const uint32_t player = take(widening.bucket, now);
+			const uint32_t opponent = take(opponentBucket, now);
+			pairs.push_back(waitedLonger ? Pair{ player, opponent } : Pair{ opponent, player });
+		}
+		else if (widening.window < mBuckets.size())
+		{
+			mWidenings.push_back(Widening{ widening.bucket, widening.sequence, widening.window + 1, now + mParameters.widenInterval });
+		}
+	}
+}
+
+uint32_t Matchmaking::bucketOf(uint16_t rating) const
+{
+	const uint32_t bucket = rating / mParameters.bucketWidth;
+	return bucket < mBuckets.size() ? bucket : static_cast<uint32_t>(mBuckets.size() - 1);
+}
+uint32_t Matchmaking::findOpponentBucket(uint32_t bucket, uint32_t window) const
+{
+	uint32_t best = None;
+	uint32_t bestDistance = window + 1;
+	const auto above = mOccupied.upper_bound(bucket);
+	if (above != mOccupied.end() && *above - bucket < bestDistance)
+	{
+		best = *above;
+		bestDistance = *above - bucket;
+	}
+	auto below = mOccupied.lower_bound(bucket);
+	if (below != mOccupied.begin())
+	{
+		--below;
+		// On a tie, prefer the player waiting the longest
+		const uint32_t distance = bucket - *below;
+		if (distance < bestDistance || (distance == bestDistance && best != None && mBuckets[*below].joined < mBuckets[best].joined))
+			best = *below;
+	}
+	return best;
+}
+void Matchmaking::wait(uint32_t bucket, uint32_t player, Clock::time_point now)
+{
+	Ticket& ticket = mBuckets[bucket];
+	ticket.player = player;
+	ticket.sequence = mNextSequence++;
+	ticket.joined = now;
+	mOccupied.insert(bucket);
+	mBucketOf[player] = bucket;
+	mWidenings.push_back(Widening{ bucket, ticket.sequence, 1, now + mParameters.widenInterval });
+}
+uint32_t Matchmaking::take(uint32_t bucket, Clock::time_point now)
+{
+	const Ticket ticket = mBuckets[bucket];
+	mTimeToMatch.add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - ticket.joined).count()));
+	leave(ticket.player);
+	return ticket.player;
+}
\ No newline at end of file
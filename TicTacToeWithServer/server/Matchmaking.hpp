@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Histogram.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <vector>
+
+// Pairs waiting players of close ratings
+// Ratings are split in buckets : a joining player is paired right away with a player waiting in the same bucket, so a bucket
+// never holds more than one waiting player. Buckets holding one are kept ordered, pairing across buckets is a lookup in O(log n).
+// The search window grows by one bucket each widenInterval a player keeps waiting, until it covers every rating.
+class Matchmaking
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	struct Parameters
+	{
+		uint16_t bucketWidth{ 25 };
+		uint16_t maxRating{ 4000 };
+		Clock::duration widenInterval{ std::chrono::milliseconds(500) };
+		// Widening steps processed per update at most, to keep the network loop responsive during bursts
+		size_t updateBudget{ 4096 };
+	};
+	struct Pair
+	{
+		// Player waiting the longest first
+		uint32_t first;
+		uint32_t second;
+	};
+	static constexpr uint32_t None = UINT32_MAX;
+public:
+	Matchmaking(size_t maxPlayers, const Parameters& parameters);
+	~Matchmaking() = default;
+
+	// Return the opponent if one was waiting in the same bucket, None if player now waits
+	uint32_t join(uint32_t player, uint16_t rating, Clock::time_point now);
+	void leave(uint32_t player);
+	bool isWaiting(uint32_t player) const { return mBucketOf[player] != None; }
+	// Widen windows of players waiting long enough and append the resulting pairs
+	void update(Clock::time_point now, std::vector<Pair>& pairs);
+
+	size_t waitingCount() const { return mOccupied.size(); }
+	// Waiting players count seen by each joining player
+	const Histogram& queueDepth() const { return mQueueDepth; }
+	// Microseconds from join to match
+	const Histogram& timeToMatch() const { return mTimeToMatch; }
+
+private:
+	struct Ticket
+	{
+		uint32_t player{ None };
+		uint32_t sequence{ 0 };
+		Clock::time_point joined;
+	};
+	// Scheduled window growth of a waiting player. Scheduled in time order so a FIFO is enough.
+	struct Widening
+	{
+		uint32_t bucket;
+		uint32_t sequence;
+		uint32_t window;
+		Clock::time_point due;
+	};
+
+	uint32_t bucketOf(uint16_t rating) const;
+	// Nearest occupied bucket in [bucket - window, bucket + window] other than bucket itself, None if any
+	uint32_t findOpponentBucket(uint32_t bucket, uint32_t window) const;
+	void wait(uint32_t bucket, uint32_t player, Clock::time_point now);
+	// Remove the player waiting in bucket, recording its waiting time
+	uint32_t take(uint32_t bucket, Clock::time_point now);
+
+private:
+	Parameters mParameters;
+	std::vector<Ticket> mBuckets;
+	std::set<uint32_t> mOccupied;
+	std::vector<uint32_t> mBucketOf;
+	std::deque<Widening> mWidenings;
+	uint32_t mNextSequence{ 1 };
+	Histogram mQueueDepth;
+	Histogram mTimeToMatch;
+};
\ No newline at end of file
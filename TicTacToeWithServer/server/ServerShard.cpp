@@ -0,0 +1,78 @@
+#include <ServerShard.hpp>
+
+
+ServerShard::ServerShard(unsigned int index, size_t maxPlayers)
+	: mMatchServer(mNetService, maxPlayers)
+	, mIndex(index)
+	, mMaxPlayers(maxPlayers)
+{
+	mNetService.addListener(&mMatchServer);
+}
+ServerShard::~ServerShard()
+{
+	stop();
+	mNetService.removeListener(&mMatchServer);
+}
+
+bool ServerShard::start(Bousk::uint16 port)
+{
+	if (mRunning)
+		return false;
+	NetService::Parameters netServiceParameters;
+	netServiceParameters.networked = true;
+	netServiceParameters.host = true;
+	netServiceParameters.localPort = port;
+	netServiceParameters.maxConnections = mMaxPlayers;
+	if (!mNetService.init(netServiceParameters))
+		return false;
+	mPort = port;
+	mRunning = true;
+	mThread = std::thread([this]() { run(); });
+	return true;
+}
+void ServerShard::stop()
+{
+	if (!mRunning)
+		return;
+	mRunning = false;
+	mThread.join();
+	mNetService.release();
+	publish();
+}
+
+ServerShard::Snapshot ServerShard::snapshot() const
+{
+	std::lock_guard<std::mutex> lock(mSnapshotMutex);
+	return mSnapshot;
+}
+
+void ServerShard::run()
+{
+	auto lastPublish = std::chrono::steady_clock::now();
+	while (mRunning)
+	{
+		const uint64_t received = mMatchServer.statistics().received;
+		mNetService.receive();
+		mNetService.process();
+		mMatchServer.update();
+		mNetService.flush();
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - lastPublish >= PublishInterval)
+		{
+			publish();
+			lastPublish = now;
+		}
+		// Only yield the core when idle so a busy shard answers as fast as it can
+		if (mMatchServer.statistics().received == received)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+void ServerShard::publish()
+{
+	std::lock_guard<std::mutex> lock(mSnapshotMutex);
+	mSnapshot.statistics = mMatchServer.statistics();
+	mSnapshot.queueDepth = mMatchServer.matchmaking().queueDepth();
+	mSnapshot.timeToMatch = mMatchServer.matchmaking().timeToMatch();
+	mSnapshot.network = mNetService.statistics();
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <MatchServer.hpp>
+#include <NetService.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// One server thread with its own socket, NetService and MatchServer
+// A match never leaves the shard its players connected to : game state is only ever touched by the shard thread
+class ServerShard
+{
+public:
+	struct Snapshot
+	{
+		MatchServer::Statistics statistics;
+		Histogram queueDepth;
+		Histogram timeToMatch;
+		NetService::Statistics network;
+	};
+public:
+	ServerShard(unsigned int index, size_t maxPlayers);
+	~ServerShard();
+
+	// Bind the shard socket and start its thread
+	bool start(Bousk::uint16 port);
+	void stop();
+
+	unsigned int index() const { return mIndex; }
+	Bousk::uint16 port() const { return mPort; }
+	// Connections telemetry can be sampled from any thread while the shard runs
+	const NetService& netService() const { return mNetService; }
+	// Copy published by the shard thread every PublishInterval, safe to call from any thread
+	Snapshot snapshot() const;
+
+private:
+	static constexpr std::chrono::milliseconds PublishInterval{ 100 };
+	void run();
+	void publish();
+
+private:
+	NetService mNetService;
+	MatchServer mMatchServer;
+	std::thread mThread;
+	std::atomic<bool> mRunning{ false };
+	unsigned int mIndex;
+	size_t mMaxPlayers;
+	Bousk::uint16 mPort{ 0 };
+
+	mutable std::mutex mSnapshotMutex;
+	Snapshot mSnapshot;
+};
\ No newline at end of file
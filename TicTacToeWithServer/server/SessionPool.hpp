@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Fixed capacity pool of T stored in slabs of SlabSize objects
+// Slabs are allocated on first use and kept until the pool is destroyed : once the live count reached its high water mark,
+// create() and destroy() never touch the heap. Objects never move, so pointers stay valid while the object lives.
+// Handles carry a generation counter : a handle to a destroyed object is detected instead of reaching its successor.
+template<class T, size_t SlabSize = 1024>
+class SessionPool
+{
+public:
+	static constexpr uint32_t None = UINT32_MAX;
+	struct Handle
+	{
+		uint32_t index{ None };
+		uint32_t generation{ 0 };
+
+		bool isValid() const { return index != None; }
+		bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Handle& other) const { return !(*this == other); }
+	};
+
+public:
+	explicit SessionPool(size_t capacity)
+		: mCapacity(capacity)
+	{
+		mSlabs.reserve((capacity + SlabSize - 1) / SlabSize);
+	}
+	~SessionPool() = default;
+	SessionPool(const SessionPool&) = delete;
+	SessionPool& operator=(const SessionPool&) = delete;
+
+	// Value initialized object, or an invalid handle when the pool is full
+	Handle create()
+	{
+		uint32_t index = mFreeHead;
+		if (index != None)
+		{
+			mFreeHead = slot(index).nextFree;
+		}
+		else
+		{
+			if (mCreated == mCapacity)
+				return Handle();
+			if (mCreated % SlabSize == 0)
+				mSlabs.push_back(std::make_unique<Slot[]>(SlabSize));
+			index = static_cast<uint32_t>(mCreated++);
+		}
+		Slot& created = slot(index);
+		created.value = T();
+		// Odd generations are alive
+		++created.generation;
+		++mSize;
+		return Handle{ index, created.generation };
+	}
+	void destroy(Handle handle)
+	{
+		if (!get(handle))
+			return;
+		Slot& destroyed = slot(handle.index);
+		++destroyed.generation;
+		destroyed.nextFree = mFreeHead;
+		mFreeHead = handle.index;
+		--mSize;
+	}
+
+	// nullptr if the handle is invalid or its object was destroyed
+	T* get(Handle handle)
+	{
+		if (handle.index >= mCreated || slot(handle.index).generation != handle.generation)
+			return nullptr;
+		return &slot(handle.index).value;
+	}
+	const T* get(Handle handle) const { return const_cast<SessionPool*>(this)->get(handle); }
+	// Handle of a live object from its index
+	Handle handle(uint32_t index) const { return Handle{ index, slot(index).generation }; }
+	// Direct access to a live object by index, without generation check
+	T& operator[](uint32_t index) { return slot(index).value; }
+	const T& operator[](uint32_t index) const { return slot(index).value; }
+
+	size_t size() const { return mSize; }
+	size_t capacity() const { return mCapacity; }
+	bool isFull() const { return mSize == mCapacity; }
+	// Memory held by allocated slabs
+	size_t memory() const { return mSlabs.size() * SlabSize * sizeof(Slot); }
+	static constexpr size_t MemoryPerObject() { return sizeof(Slot); }
+
+private:
+	struct Slot
+	{
+		T value{};
+		uint32_t generation{ 0 };
+		uint32_t nextFree{ None };
+	};
+	Slot& slot(uint32_t index) { return mSlabs[index / SlabSize][index % SlabSize]; }
+	const Slot& slot(uint32_t index) const { return mSlabs[index / SlabSize][index % SlabSize]; }
+
+private:
+	std::vector<std::unique_ptr<Slot[]>> mSlabs;
+	size_t mCapacity;
+	// Slots handed out at least once. Beyond, slots are neither constructed nor in the free list.
+	size_t mCreated{ 0 };
+	size_t mSize{ 0 };
+	uint32_t mFreeHead{ None };
+};
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <ServerShard.hpp>
+
+#include <CommandLine.hpp>
+#include <Errors.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr Bousk::uint16 HostPort = 8888;
+
+static std::atomic<bool> Running{ true };
+
+int main(int argc, char* argv[])
+{
+    Bousk::uint16 port = HostPort;
+    size_t maxPlayers = 100000;
+    unsigned int shardsCount = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        bool valid;
+        if (arg.rfind("-port:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(6), port, 1);
+        else if (arg.rfind("-maxPlayers:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(12), maxPlayers, 1);
+        else if (arg.rfind("-shards:", 0) == 0)
+            valid = CommandLine::ParseInteger(arg.substr(8), shardsCount, 1);
+        else
+            valid = false;
+        if (!valid)
+        {
+            std::cout << "Usage : " << argv[0] << " [-port:N] [-maxPlayers:N] [-shards:N]" << std::endl;
+            return -1;
+        }
+    }
+    // Every shard needs a port of its own, and room for a player
+    if (shardsCount > 65536u - port || maxPlayers < shardsCount)
+    {
+        std::cout << shardsCount << " shards need as many ports from " << port << " up to 65535, and at least one player each" << std::endl;
+        return -1;
+    }
+
+    // Each shard listens on its own port, from port to port + shards - 1 : clients pick one and stay on it
+    std::vector<std::unique_ptr<ServerShard>> shards;
+    for (unsigned int i = 0; i < shardsCount; ++i)
+    {
+        shards.push_back(std::make_unique<ServerShard>(i, maxPlayers / shardsCount));
+        if (!shards.back()->start(static_cast<Bousk::uint16>(port + i)))
+        {
+            std::cout << "Shard " << i << " initialization error : " << Bousk::Network::Errors::Get();
+            return -2;
+        }
+    }
+    std::signal(SIGINT, [](int) { Running = false; });
+
+    std::cout << "Server listening on ports " << port << " to " << (port + shardsCount - 1) << " for up to " << maxPlayers << " players" << std::endl;
+    std::cout << "Server memory per match : " << MatchServer::MemoryPerMatch() << " bytes, at most " << (MatchServer::MemoryPerMatch() * (maxPlayers / 2) / (1024 * 1024)) << " MB, network connections not included" << std::endl;
+
+    auto lastReport = std::chrono::steady_clock::now();
+    uint64_t lastMoves = 0;
+    uint64_t lastSpectatorUpdates = 0;
+    while (Running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport < std::chrono::seconds(5))
+            continue;
+
+        MatchServer::Statistics total;
+        Histogram queueDepth;
+        Histogram timeToMatch;
+        NetService::Statistics network;
+        for (const auto& shard : shards)
+        {
+            const ServerShard::Snapshot snapshot = shard->snapshot();
+            const MatchServer::Statistics& statistics = snapshot.statistics;
+            total.connectedPlayers += statistics.connectedPlayers;
+            total.activeMatches += statistics.activeMatches;
+            total.waitingPlayers += statistics.waitingPlayers;
+            total.matchesFinished += statistics.matchesFinished;
+            total.moves += statistics.moves;
+            total.rejectedMoves += statistics.rejectedMoves;
+            total.resyncs += statistics.resyncs;
+            total.absentPlayers += statistics.absentPlayers;
+            total.rejoins += statistics.rejoins;
+            total.spectators += statistics.spectators;
+            total.broadcastPackets += statistics.broadcastPackets;
+            total.spectatorUpdates += statistics.spectatorUpdates;
+            total.coalescedUpdates += statistics.coalescedUpdates;
+            queueDepth.merge(snapshot.queueDepth);
+            timeToMatch.merge(snapshot.timeToMatch);
+            network.dispatchedMessages += snapshot.network.dispatchedMessages;
+            network.dispatchTime += snapshot.network.dispatchTime;
+        }
+        const std::chrono::duration<double> elapsed = now - lastReport;
+        std::cout << "Players " << total.connectedPlayers << " (" << total.waitingPlayers << " waiting, " << total.absentPlayers << " absent, " << total.rejoins << " rejoined)"
+            << ", matches " << total.activeMatches << " live / " << total.matchesFinished << " finished"
+            << ", " << ((total.moves - lastMoves) / elapsed.count()) << " moves/s"
+            << ", " << total.rejectedMoves << " rejected, " << total.resyncs << " resyncs" << std::endl;
+        std::cout << "  Queue depth p50 " << queueDepth.percentile(50) << " p99 " << queueDepth.percentile(99)
+            << ", time to match p50 " << timeToMatch.percentile(50) << "us p99 " << timeToMatch.percentile(99) << "us max " << timeToMatch.max() << "us" << std::endl;
+        std::cout << "  Dispatch " << network.nanosecondsPerMessage() << "ns per message" << std::endl;
+        // Sampled without stopping the shards : counters of a connection are read while its shard updates them
+        Histogram rtt;
+        uint64_t pingsSent = 0;
+        uint64_t pongsReceived = 0;
+        uint32_t maxQueuedDatagrams = 0;
+        std::chrono::microseconds worstSmoothedRtt{ 0 };
+        NetService::ConnectionSample sample;
+        for (const auto& shard : shards)
+        {
+            const NetService& netService = shard->netService();
+            for (size_t i = 0; i < netService.connectionsCapacity(); ++i)
+            {
+                if (!netService.sampleConnection(i, sample))
+                    continue;
+                rtt.merge(sample.rtt);
+                pingsSent += sample.pingsSent;
+                pongsReceived += sample.pongsReceived;
+                maxQueuedDatagrams = std::max(maxQueuedDatagrams, sample.maxQueuedDatagrams);
+                worstSmoothedRtt = std::max(worstSmoothedRtt, sample.smoothedRtt);
+            }
+        }
+        std::cout << "  RTT p50 " << rtt.percentile(50) << "us p99 " << rtt.percentile(99) << "us, worst smoothed " << worstSmoothedRtt.count() << "us, "
+            << (pingsSent - pongsReceived) << " pings unanswered, at most " << maxQueuedDatagrams << " datagrams queued at once" << std::endl;
+        if (total.spectators > 0)
+        {
+            std::cout << "  Spectators " << total.spectators << ", " << ((total.spectatorUpdates - lastSpectatorUpdates) / elapsed.count()) << " updates/s from "
+                << total.broadcastPackets << " packets encoded, " << total.coalescedUpdates << " coalesced" << std::endl;
+        }
+        lastReport = now;
+        lastMoves = total.moves;
+        lastSpectatorUpdates = total.spectatorUpdates;
+    }
+
+    for (auto& shard : shards)
+        shard->stop();
+    return 0;
+}
\ No newline at end of file
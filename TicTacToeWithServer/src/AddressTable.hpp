@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Address.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Open addressing table from addresses to indexes of objects stored elsewhere
+// Linear probing, kept at most half full. Slots keep the hash of their address : a probe only compares addresses
+// when hashes match, and a removal moves entries back without hashing them again.
+class AddressTable
+{
+public:
+	static constexpr uint32_t None = UINT32_MAX;
+
+	explicit AddressTable(size_t capacity = 0)
+		: mSlots(SizeFor(capacity))
+	{}
+
+	// Index stored for address, or None. addressOf(index) gives back the address of a stored index.
+	template<class AddressOf>
+	uint32_t find(const Bousk::Network::Address& address, AddressOf&& addressOf) const
+	{
+		const uint32_t hash = Hash(address);
+		for (size_t slot = hash & mask(); mSlots[slot].index != None; slot = (slot + 1) & mask())
+		{
+			if (mSlots[slot].hash == hash && addressOf(mSlots[slot].index) == address)
+				return mSlots[slot].index;
+		}
+		return None;
+	}
+	// address must not be in the table yet, which must hold less than its capacity
+	void insert(const Bousk::Network::Address& address, uint32_t index)
+	{
+		const uint32_t hash = Hash(address);
+		size_t slot = hash & mask();
+		while (mSlots[slot].index != None)
+			slot = (slot + 1) & mask();
+		mSlots[slot] = { index, hash };
+	}
+	// Remove index, inserted for address
+	void erase(const Bousk::Network::Address& address, uint32_t index)
+	{
+		size_t hole = Hash(address) & mask();
+		while (mSlots[hole].index != index)
+			hole = (hole + 1) & mask();
+		// Backward shift deletion : move back entries of the probe sequence so lookups never need tombstones
+		for (size_t slot = (hole + 1) & mask(); mSlots[slot].index != None; slot = (slot + 1) & mask())
+		{
+			const size_t home = mSlots[slot].hash & mask();
+			// Entry can move to the hole only if its home isn't cyclically in ]hole, slot]
+			const bool homeBetween = hole <= slot ? (home > hole && home <= slot) : (home > hole || home <= slot);
+			if (!homeBetween)
+			{
+				mSlots[hole] = mSlots[slot];
+				hole = slot;
+			}
+		}
+		mSlots[hole] = Slot();
+	}
+
+	size_t memory() const { return mSlots.size() * sizeof(Slot); }
+	// Memory per entry of a full table
+	static constexpr size_t MemoryPerEntry() { return 2 * sizeof(Slot); }
+
+private:
+	struct Slot
+	{
+		uint32_t index{ None };
+		uint32_t hash{ 0 };
+	};
+	static uint32_t Hash(const Bousk::Network::Address& address)
+	{
+		// Both IP and port : clients behind one NAT share their IP, loopback bots on different IPs may share a port
+		// Address exposes its IP as text only. An IPv4 one fits the small string buffer : no allocation.
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (const char c : address.address())
+			hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+		hash = (hash ^ address.port()) * 0x9E3779B97F4A7C15ull;
+		return static_cast<uint32_t>(hash >> 32);
+	}
+	static size_t SizeFor(size_t capacity)
+	{
+		size_t size = 16;
+		while (size < capacity * 2)
+			size *= 2;
+		return size;
+	}
+	size_t mask() const { return mSlots.size() - 1; }
+
+private:
+	std::vector<Slot> mSlots;
+};
\ No newline at end of file
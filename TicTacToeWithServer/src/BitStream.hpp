@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TicTacToe
+{
+	// Write values of any bit width into a caller provided buffer, least significant bits first
+	class BitWriter
+	{
+	public:
+		BitWriter(uint8_t* buffer, size_t capacity)
+			: mBuffer(buffer)
+			, mCapacityBits(capacity * 8)
+		{}
+
+		// Write the bits lowest bits of value. Return false and write nothing if the buffer is full.
+		bool write(uint32_t value, unsigned int bits)
+		{
+			if (mBits + bits > mCapacityBits)
+				return false;
+			while (bits)
+			{
+				const unsigned int offset = static_cast<unsigned int>(mBits % 8);
+				const unsigned int count = bits < 8 - offset ? bits : 8 - offset;
+				const uint8_t chunk = static_cast<uint8_t>((value & ((1u << count) - 1)) << offset);
+				// Bytes are not cleared beforehand : the first write into a byte overwrites it
+				uint8_t& byte = mBuffer[mBits / 8];
+				byte = offset ? static_cast<uint8_t>(byte | chunk) : chunk;
+				value >>= count;
+				bits -= count;
+				mBits += count;
+			}
+			return true;
+		}
+		void clear() { mBits = 0; }
+		// Drop what was written after the first bits, which must not be more than written
+		void rewind(size_t bits)
+		{
+			mBits = bits;
+			// Zero the dropped bits of the last byte : next writes OR into it, and readers rely on the zero padding
+			if (mBits % 8)
+				mBuffer[mBits / 8] &= static_cast<uint8_t>((1u << (mBits % 8)) - 1);
+		}
+
+		size_t bitsCount() const { return mBits; }
+		// Bytes used, last one padded with zeros
+		size_t size() const { return (mBits + 7) / 8; }
+		size_t remainingBits() const { return mCapacityBits - mBits; }
+		const uint8_t* data() const { return mBuffer; }
+
+	private:
+		uint8_t* mBuffer;
+		size_t mCapacityBits;
+		size_t mBits{ 0 };
+	};
+
+	class BitReader
+	{
+	public:
+		BitReader(const uint8_t* buffer, size_t size)
+			: mBuffer(buffer)
+			, mSizeBits(size * 8)
+		{}
+
+		bool read(uint32_t& value, unsigned int bits)
+		{
+			if (mBits + bits > mSizeBits)
+				return false;
+			value = 0;
+			for (unsigned int done = 0; done < bits;)
+			{
+				const unsigned int offset = static_cast<unsigned int>(mBits % 8);
+				const unsigned int count = bits - done < 8 - offset ? bits - done : 8 - offset;
+				const uint32_t chunk = (mBuffer[mBits / 8] >> offset) & ((1u << count) - 1);
+				value |= chunk << done;
+				done += count;
+				mBits += count;
+			}
+			return true;
+		}
+
+		size_t remainingBits() const { return mSizeBits - mBits; }
+
+	private:
+		const uint8_t* mBuffer;
+		size_t mSizeBits;
+		size_t mBits{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <ClientMatch.hpp>
+
+namespace TicTacToe
+{
+	namespace Net
+	{
+		void ClientMatch::start(Case symbol)
+		{
+			mGrid = Grid();
+			mSymbol = symbol;
+			mTurn = Case::X;
+			mOutOfSync = false;
+			mResyncSent = false;
+			mSeated = false;
+		}
+		bool ClientMatch::play(unsigned int x, unsigned int y)
+		{
+			if (!mGrid.play(x, y, mTurn))
+				return false;
+			mTurn = mTurn == Case::X ? Case::O : Case::X;
+			return true;
+		}
+		ClientMatch::DeltaResult ClientMatch::apply(const Delta& delta)
+		{
+			// Already known, or received while waiting for the snapshot
+			if (mOutOfSync || delta.sequence <= mGrid.playedCount())
+				return DeltaResult::Ignored;
+			if (delta.sequence != mGrid.playedCount() + 1 || !play(delta.x, delta.y))
+			{
+				// Missed a move : get the whole board back
+				mOutOfSync = true;
+				mResyncSent = false;
+				return DeltaResult::OutOfSync;
+			}
+			return DeltaResult::Applied;
+		}
+		bool ClientMatch::restore(const Snapshot& snapshot)
+		{
+			if (!snapshot.restore(mGrid))
+				return false;
+			mTurn = mGrid.playedCount() % 2 ? Case::O : Case::X;
+			mOutOfSync = false;
+			mResyncSent = false;
+			return true;
+		}
+		Rejoin ClientMatch::rejoin() const
+		{
+			Rejoin rejoin;
+			rejoin.seat = mSeat;
+			return rejoin;
+		}
+	}
+}
\ No newline at end of file
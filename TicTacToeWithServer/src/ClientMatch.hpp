@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Game.hpp>
+#include <Net.hpp>
+
+namespace TicTacToe
+{
+	namespace Net
+	{
+		// Client copy of a match run by the server, kept up to date from its Start, Seat, Delta and Snapshot messages
+		// A gap in the deltas makes it out of sync : deltas are then ignored until the Resync snapshot comes
+		// A client reconnecting during the match sends rejoin() instead of Hello : the server answers with a Snapshot
+		class ClientMatch
+		{
+		public:
+			enum class DeltaResult
+			{
+				// Already known, or out of sync
+				Ignored,
+				Applied,
+				// A move was missed : send a Resync
+				OutOfSync,
+			};
+		public:
+			// New match with an empty grid, X plays first
+			void start(Case symbol);
+			// Play a move for the player whose turn it is
+			bool play(unsigned int x, unsigned int y);
+			DeltaResult apply(const Delta& delta);
+			// Return false, leaving the match as it was, if the snapshot is not a reachable position
+			bool restore(const Snapshot& snapshot);
+			void seat(const Seat& seat) { mSeat = seat; mSeated = true; }
+			// Seated in a match not over yet : worth a Rejoin after reconnecting
+			bool canRejoin() const { return mSeated && !mGrid.isFinished(); }
+			Rejoin rejoin() const;
+
+			// Out of sync and the Resync isn't sent yet : keep trying, then call resyncSent()
+			bool needsResync() const { return mOutOfSync && !mResyncSent; }
+			void resyncSent() { mResyncSent = true; }
+			bool isOutOfSync() const { return mOutOfSync; }
+			// Never while out of sync : the grid is known to be wrong
+			bool isMyTurn() const { return !mOutOfSync && !mGrid.isFinished() && mTurn == mSymbol; }
+
+			const Grid& grid() const { return mGrid; }
+			Case symbol() const { return mSymbol; }
+			Case turn() const { return mTurn; }
+
+		private:
+			Grid mGrid;
+			Case mSymbol{ Case::Empty };
+			Case mTurn{ Case::X };
+			bool mOutOfSync{ false };
+			bool mResyncSent{ false };
+			Seat mSeat;
+			bool mSeated{ false };
+		};
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <string>
+
+// Values of "-name:value" command line arguments
+// The whole text must be a number within [min, max] : signs, trailing characters and values out of range fail instead of throwing or wrapping
+namespace CommandLine
+{
+	template<class Integer>
+	bool ParseInteger(const std::string& text, Integer& value, uint64_t min = 0, uint64_t max = std::numeric_limits<Integer>::max())
+	{
+		if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0])))
+			return false;
+		try
+		{
+			size_t parsed = 0;
+			const unsigned long long result = std::stoull(text, &parsed);
+			if (parsed != text.size() || result < min || result > max || result > std::numeric_limits<Integer>::max())
+				return false;
+			value = static_cast<Integer>(result);
+			return true;
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+	inline bool ParseFloat(const std::string& text, float& value, float min, float max)
+	{
+		if (text.empty() || !(std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '.'))
+			return false;
+		try
+		{
+			size_t parsed = 0;
+			const float result = std::stof(text, &parsed);
+			if (parsed != text.size() || !std::isfinite(result) || result < min || result > max)
+				return false;
+			value = result;
+			return true;
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+}
\ No newline at end of file
@@ -1,37 +1,331 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 
 namespace TicTacToe
 {
-	enum class Case
+	enum class Case : uint8_t
 	{
 		Empty,
 		X,
 		O,
 	};
-	class Grid
+	// 3x3 bitboard helpers : bit (x * 3 + y) is case [x][y]
+	namespace Bitboard
 	{
+		constexpr uint16_t Bit(unsigned int x, unsigned int y) { return static_cast<uint16_t>(1u << (x * 3 + y)); }
+		constexpr uint16_t FullMask = 0x1FF;
+		// All 3 in a row lines : 3 horizontals, 3 verticals & 2 diagonals
+		constexpr std::array<uint16_t, 8> WinMasks{
+			0x007, 0x038, 0x1C0,
+			0x049, 0x092, 0x124,
+			0x111, 0x054,
+		};
+		// Return true if given bitboard contains a full line
+		constexpr bool HasLine(uint16_t bitboard)
+		{
+			bool hasLine = false;
+			for (uint16_t mask : WinMasks)
+				hasLine |= (bitboard & mask) == mask;
+			return hasLine;
+		}
+	}
+	// Zobrist keys : a grid hash is the XOR of the keys of its played cases, so it's updated in O(1) by each move
+	// and XORing the same key again takes the move back
+	namespace Zobrist
+	{
+		// Key of player owning case index (x * Height + y), derived with splitmix64 so no table needs to be built
+		constexpr uint64_t Key(unsigned int caseIndex, Case player)
+		{
+			uint64_t z = (caseIndex * 2ull + (player == Case::O ? 1 : 0) + 1) * 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+	}
+	// Grid of W x H cases where a player wins by aligning K of his symbols
+	template<unsigned int W, unsigned int H, unsigned int K>
+	class BasicGrid
+	{
+		static_assert(W > 0 && H > 0, "Grid can't be empty");
+		static_assert(K > 1 && (K <= W || K <= H), "Line length must fit in the grid");
+		static_assert(W * H <= 0x10000, "Case index must fit on 16 bits");
 	public:
-		Grid() = default;
-		~Grid() = default;
+		static constexpr unsigned int Width = W;
+		static constexpr unsigned int Height = H;
+		static constexpr unsigned int LineLength = K;
+
+		BasicGrid() = default;
+		~BasicGrid() = default;
 
 		// Play a move from given player in given case. Return true if it's valid, false otherwise.
 		bool play(unsigned int x, unsigned int y, Case player);
+		// Take back the last move. Return false if there is none, true otherwise.
+		bool unplay();
+		unsigned int playedCount() const { return mPlayedCount; }
 		// Return true if the game is over, false otherwise
 		bool isFinished() const { return mFinished; }
 		// Return winner, if any, Case::Empty otherwise
 		Case winner() const { return mWinner; }
 
-		const std::array<std::array<Case, 3>, 3>& grid() const { return mGrid; }
+		const std::array<std::array<Case, H>, W>& grid() const { return mGrid; }
+		// Zobrist hash of the grid
+		uint64_t hash() const { return mHash; }
+		// Hash change brought by a move : hash() ^ MoveKey() is the hash after (or before) that move
+		static constexpr uint64_t MoveKey(unsigned int x, unsigned int y, Case player) { return Zobrist::Key(x * H + y, player); }
 
 	private:
 		// Check if the grid is full
-		bool isGridFull() const;
+		bool isGridFull() const { return mPlayedCount == W * H; }
+		// Number of consecutive cases owned by player starting next to (x, y) in direction (dx, dy), up to K - 1
+		unsigned int alignedCount(unsigned int x, unsigned int y, int dx, int dy, Case player) const;
+
+	private:
+		std::array<std::array<Case, H>, W> mGrid{};
+		// Played moves as case index x * H + y, the first mPlayedCount are valid
+		std::array<uint16_t, W * H> mMoves{};
+		unsigned int mPlayedCount{ 0 };
+		uint64_t mHash{ 0 };
+		Case mWinner{ Case::Empty };
+		bool mFinished{ false };
+	};
+
+	// 3x3 with 3 in a row is the classic game : use bitboards
+	template<>
+	class BasicGrid<3, 3, 3>
+	{
+	public:
+		static constexpr unsigned int Width = 3;
+		static constexpr unsigned int Height = 3;
+		static constexpr unsigned int LineLength = 3;
+
+		constexpr BasicGrid() = default;
+		~BasicGrid() = default;
+
+		// Play a move from given player in given case. Return true if it's valid, false otherwise.
+		constexpr bool play(unsigned int x, unsigned int y, Case player);
+		// Take back the last move. Return false if there is none, true otherwise.
+		constexpr bool unplay();
+		// Replace the grid by the position owning given cases, as received in a snapshot : no move is replayed
+		// Return false, leaving the grid as it was, if it can't be reached by X and O playing in turn
+		constexpr bool reset(uint16_t xBitboard, uint16_t oBitboard);
+		constexpr unsigned int playedCount() const { return mPlayedCount; }
+		// Return true if the game is over, false otherwise
+		constexpr bool isFinished() const { return mFinished; }
+		// Return winner, if any, Case::Empty otherwise
+		constexpr Case winner() const { return mWinner; }
+
+		constexpr const std::array<std::array<Case, 3>, 3>& grid() const { return mGrid; }
+		// Cases owned by given player, one bit per case : bit (x * 3 + y) is case [x][y]
+		// Case::Empty returns the free cases
+		constexpr uint16_t bitboard(Case player) const;
+		// Position as a base 3 number : digit (x * 3 + y) is case [x][y] as 0 Empty, 1 X, 2 O
+		constexpr uint16_t positionIndex() const { return mPositionIndex; }
+		// Zobrist hash of the grid
+		constexpr uint64_t hash() const { return mHash; }
+		// Hash change brought by a move : hash() ^ MoveKey() is the hash after (or before) that move
+		static constexpr uint64_t MoveKey(unsigned int x, unsigned int y, Case player) { return Zobrist::Key(x * 3 + y, player); }
+
+		static constexpr unsigned int PositionsCount = 19683;
+		static constexpr std::array<uint16_t, 9> PositionIndexDigits{ 1, 3, 9, 27, 81, 243, 729, 2187, 6561 };
+
+	private:
+		// Check if the grid is full
+		constexpr bool isGridFull() const { return (mBitboards[0] | mBitboards[1]) == Bitboard::FullMask; }
 
 	private:
 		std::array<std::array<Case, 3>, 3> mGrid{ Case::Empty, Case::Empty, Case::Empty, Case::Empty, Case::Empty, Case::Empty, Case::Empty, Case::Empty, Case::Empty };
+		// One bitboard per player : X then O
+		std::array<uint16_t, 2> mBitboards{ 0, 0 };
+		uint16_t mPositionIndex{ 0 };
+		uint64_t mHash{ 0 };
+		// Played moves as case index x * 3 + y, the first mPlayedCount are valid
+		std::array<uint8_t, 9> mMoves{};
+		uint8_t mPlayedCount{ 0 };
 		Case mWinner{ Case::Empty };
 		bool mFinished{ false };
 	};
+	using Grid = BasicGrid<3, 3, 3>;
+	using Gomoku15 = BasicGrid<15, 15, 5>;
+	using Gomoku19 = BasicGrid<19, 19, 5>;
+
+	constexpr bool BasicGrid<3, 3, 3>::play(unsigned int x, unsigned int y, Case player)
+	{
+		if (x > 2 || y > 2)
+			return false;
+		if (player == Case::Empty || mFinished)
+			return false;
+		const uint16_t bit = Bitboard::Bit(x, y);
+		if ((mBitboards[0] | mBitboards[1]) & bit)
+			return false;
+
+		mGrid[x][y] = player;
+		uint16_t& playerBitboard = mBitboards[player == Case::X ? 0 : 1];
+		playerBitboard |= bit;
+		mPositionIndex += static_cast<uint16_t>(PositionIndexDigits[x * 3 + y] * static_cast<unsigned int>(player));
+		mHash ^= MoveKey(x, y, player);
+		mMoves[mPlayedCount++] = static_cast<uint8_t>(x * 3 + y);
+		// Check if the game is now over
+		if (Bitboard::HasLine(playerBitboard))
+		{
+			mWinner = player;
+			mFinished = true;
+		}
+		else if (isGridFull())
+		{
+			mFinished = true;
+		}
+		return true;
+	}
+	constexpr bool BasicGrid<3, 3, 3>::unplay()
+	{
+		if (mPlayedCount == 0)
+			return false;
+		const unsigned int index = mMoves[--mPlayedCount];
+		const unsigned int x = index / 3;
+		const unsigned int y = index % 3;
+		const Case player = mGrid[x][y];
+		mGrid[x][y] = Case::Empty;
+		mBitboards[player == Case::X ? 0 : 1] &= static_cast<uint16_t>(~Bitboard::Bit(x, y));
+		mPositionIndex -= static_cast<uint16_t>(PositionIndexDigits[index] * static_cast<unsigned int>(player));
+		mHash ^= MoveKey(x, y, player);
+		// No move can be played once the game is over : before the last move, it was still running
+		mWinner = Case::Empty;
+		mFinished = false;
+		return true;
+	}
+	constexpr bool BasicGrid<3, 3, 3>::reset(uint16_t xBitboard, uint16_t oBitboard)
+	{
+		if (((xBitboard | oBitboard) & ~Bitboard::FullMask) || (xBitboard & oBitboard))
+			return false;
+		unsigned int xCount = 0;
+		unsigned int oCount = 0;
+		for (unsigned int i = 0; i < 9; ++i)
+		{
+			xCount += (xBitboard >> i) & 1;
+			oCount += (oBitboard >> i) & 1;
+		}
+		// X plays first
+		if (xCount != oCount && xCount != oCount + 1)
+			return false;
+		// The game stops at the first line : only the player who moved last may have one
+		const bool xLine = Bitboard::HasLine(xBitboard);
+		const bool oLine = Bitboard::HasLine(oBitboard);
+		if ((xLine && xCount != oCount + 1) || (oLine && xCount != oCount))
+			return false;
+		// Its last move completed every line it has : without one of its cases, it must have none
+		uint16_t last = 0;
+		if (xLine || oLine)
+		{
+			const uint16_t winnerBitboard = xLine ? xBitboard : oBitboard;
+			for (unsigned int i = 0; i < 9 && !last; ++i)
+			{
+				const uint16_t bit = static_cast<uint16_t>(1u << i);
+				if ((winnerBitboard & bit) && !Bitboard::HasLine(static_cast<uint16_t>(winnerBitboard & ~bit)))
+					last = bit;
+			}
+			if (!last)
+				return false;
+		}
+
+		BasicGrid grid;
+		// Order of the moves is lost : rebuild a history alternating X and O cases, the winning case last,
+		// so no position before the last one is finished and unplay() takes back legal moves
+		std::array<uint16_t, 2> remaining{ static_cast<uint16_t>(xBitboard & ~last), static_cast<uint16_t>(oBitboard & ~last) };
+		for (unsigned int i = 0; i < xCount + oCount; ++i)
+		{
+			uint16_t& cases = remaining[i % 2];
+			// The winner runs out of cases right before its last move
+			const uint16_t bit = cases ? static_cast<uint16_t>(cases & (0u - cases)) : last;
+			cases = static_cast<uint16_t>(cases & ~bit);
+			unsigned int index = 0;
+			while (!((bit >> index) & 1))
+				++index;
+			const Case player = (i % 2) == 0 ? Case::X : Case::O;
+			grid.mGrid[index / 3][index % 3] = player;
+			grid.mPositionIndex += static_cast<uint16_t>(PositionIndexDigits[index] * static_cast<unsigned int>(player));
+			grid.mHash ^= MoveKey(index / 3, index % 3, player);
+			grid.mMoves[grid.mPlayedCount++] = static_cast<uint8_t>(index);
+		}
+		grid.mBitboards = { xBitboard, oBitboard };
+		grid.mWinner = xLine ? Case::X : oLine ? Case::O : Case::Empty;
+		grid.mFinished = grid.mWinner != Case::Empty || grid.isGridFull();
+		*this = grid;
+		return true;
+	}
+	constexpr uint16_t BasicGrid<3, 3, 3>::bitboard(Case player) const
+	{
+		switch (player)
+		{
+			case Case::X: return mBitboards[0];
+			case Case::O: return mBitboards[1];
+			default: return static_cast<uint16_t>(~(mBitboards[0] | mBitboards[1]) & Bitboard::FullMask);
+		}
+	}
+
+	template<unsigned int W, unsigned int H, unsigned int K>
+	bool BasicGrid<W, H, K>::play(unsigned int x, unsigned int y, Case player)
+	{
+		if (x >= W || y >= H)
+			return false;
+		if (player == Case::Empty || mFinished)
+			return false;
+		if (mGrid[x][y] != Case::Empty)
+			return false;
+
+		mGrid[x][y] = player;
+		mMoves[mPlayedCount++] = static_cast<uint16_t>(x * H + y);
+		mHash ^= MoveKey(x, y, player);
+		// Check if the game is now over : only lines going through this case can have changed
+		constexpr int Directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+		bool justWon = false;
+		for (const auto& direction : Directions)
+		{
+			const unsigned int aligned = 1 + alignedCount(x, y, direction[0], direction[1], player) + alignedCount(x, y, -direction[0], -direction[1], player);
+			justWon |= aligned >= K;
+		}
+		if (justWon)
+		{
+			mWinner = player;
+			mFinished = true;
+		}
+		else if (isGridFull())
+		{
+			mFinished = true;
+		}
+		return true;
+	}
+	template<unsigned int W, unsigned int H, unsigned int K>
+	bool BasicGrid<W, H, K>::unplay()
+	{
+		if (mPlayedCount == 0)
+			return false;
+		const unsigned int index = mMoves[--mPlayedCount];
+		const unsigned int x = index / H;
+		const unsigned int y = index % H;
+		mHash ^= MoveKey(x, y, mGrid[x][y]);
+		mGrid[x][y] = Case::Empty;
+		// No move can be played once the game is over : before the last move, it was still running
+		mWinner = Case::Empty;
+		mFinished = false;
+		return true;
+	}
+	template<unsigned int W, unsigned int H, unsigned int K>
+	unsigned int BasicGrid<W, H, K>::alignedCount(unsigned int x, unsigned int y, int dx, int dy, Case player) const
+	{
+		unsigned int count = 0;
+		int cx = static_cast<int>(x) + dx;
+		int cy = static_cast<int>(y) + dy;
+		while (count < K - 1
+			&& cx >= 0 && cx < static_cast<int>(W)
+			&& cy >= 0 && cy < static_cast<int>(H)
+			&& mGrid[cx][cy] == player)
+		{
+			++count;
+			cx += dx;
+			cy += dy;
+		}
+		return count;
+	}
 }
\ No newline at end of file
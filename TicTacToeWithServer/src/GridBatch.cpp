@@ -0,0 +1,192 @@
+#include <GridBatch.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define GRIDBATCH_SSE2 1
+	#include <emmintrin.h>
+#endif
+// Only the AVX2 kernel is compiled for AVX2 : the rest of the build runs on any x86 CPU, and the kernel is picked at runtime
+#if defined(GRIDBATCH_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+	#define GRIDBATCH_AVX2 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		// MSVC compiles AVX2 intrinsics without /arch:AVX2
+		#define GRIDBATCH_TARGET_AVX2
+	#else
+		#define GRIDBATCH_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+namespace
+{
+	bool CpuSupportsAVX2()
+	{
+#if !defined(GRIDBATCH_AVX2)
+		return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		// The OS must also save the YMM registers
+		__cpuid(info, 1);
+		if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+	const bool HasAVX2 = CpuSupportsAVX2();
+}
+
+namespace TicTacToe
+{
+	GridBatch::Kernel GridBatch::BestKernel()
+	{
+		if (HasAVX2)
+			return Kernel::AVX2;
+#if defined(GRIDBATCH_SSE2)
+		return Kernel::SSE2;
+#else
+		return Kernel::Scalar;
+#endif
+	}
+	const char* GridBatch::KernelName(Kernel kernel)
+	{
+		switch (kernel)
+		{
+			case Kernel::Scalar: return "Scalar";
+			case Kernel::SSE2: return "SSE2";
+			case Kernel::AVX2: return "AVX2";
+		}
+		return "Unknown";
+	}
+
+	void GridBatch::reserve(size_t capacity)
+	{
+		mX.reserve(capacity);
+		mO.reserve(capacity);
+		mWinners.reserve(capacity);
+		mFinished.reserve(capacity);
+		mLegalMoves.reserve(capacity);
+	}
+	void GridBatch::clear()
+	{
+		mX.clear();
+		mO.clear();
+	}
+	void GridBatch::add(uint16_t x, uint16_t o)
+	{
+		mX.push_back(x);
+		mO.push_back(o);
+	}
+
+	void GridBatch::evaluate(Kernel kernel)
+	{
+		mWinners.resize(size());
+		mFinished.resize(size());
+		mLegalMoves.resize(size());
+		size_t evaluated = 0;
+		switch (kernel)
+		{
+			case Kernel::AVX2: evaluated = HasAVX2 ? evaluateAVX2() : evaluateSSE2(); break;
+			case Kernel::SSE2: evaluated = evaluateSSE2(); break;
+			case Kernel::Scalar: break;
+		}
+		evaluateScalar(evaluated, size());
+	}
+
+	void GridBatch::evaluateScalar(size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const uint16_t x = mX[i];
+			const uint16_t o = mO[i];
+			const Case winner = Bitboard::HasLine(x) ? Case::X : (Bitboard::HasLine(o) ? Case::O : Case::Empty);
+			const bool finished = winner != Case::Empty || (x | o) == Bitboard::FullMask;
+			mWinners[i] = static_cast<uint8_t>(winner);
+			mFinished[i] = finished ? 1 : 0;
+			mLegalMoves[i] = finished ? 0 : static_cast<uint16_t>(~(x | o) & Bitboard::FullMask);
+		}
+	}
+
+	size_t GridBatch::evaluateSSE2()
+	{
+#if defined(GRIDBATCH_SSE2)
+		constexpr size_t Lanes = 8;
+		const size_t count = size() - size() % Lanes;
+		const __m128i full = _mm_set1_epi16(Bitboard::FullMask);
+		const __m128i one = _mm_set1_epi16(1);
+		for (size_t i = 0; i < count; i += Lanes)
+		{
+			const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mX[i]));
+			const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mO[i]));
+			__m128i xWon = _mm_setzero_si128();
+			__m128i oWon = _mm_setzero_si128();
+			for (uint16_t line : Bitboard::WinMasks)
+			{
+				const __m128i mask = _mm_set1_epi16(static_cast<short>(line));
+				xWon = _mm_or_si128(xWon, _mm_cmpeq_epi16(_mm_and_si128(x, mask), mask));
+				oWon = _mm_or_si128(oWon, _mm_cmpeq_epi16(_mm_and_si128(o, mask), mask));
+			}
+			// Case::X is 1 and Case::O is 2 : X lanes get 1, O lanes get 2
+			const __m128i winner = _mm_or_si128(_mm_and_si128(xWon, one), _mm_and_si128(_mm_andnot_si128(xWon, oWon), _mm_add_epi16(one, one)));
+			const __m128i occupied = _mm_or_si128(x, o);
+			const __m128i finished = _mm_or_si128(_mm_or_si128(xWon, oWon), _mm_cmpeq_epi16(occupied, full));
+			const __m128i legal = _mm_andnot_si128(finished, _mm_andnot_si128(occupied, full));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&mLegalMoves[i]), legal);
+			// Narrow 16 bits lanes to bytes : only the low 8 bytes are meaningful
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&mWinners[i]), _mm_packus_epi16(winner, winner));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(&mFinished[i]), _mm_packus_epi16(_mm_and_si128(finished, one), _mm_setzero_si128()));
+		}
+		return count;
+#else
+		return 0;
+#endif
+	}
+
+#if defined(GRIDBATCH_AVX2)
+	GRIDBATCH_TARGET_AVX2
+#endif
+	size_t GridBatch::evaluateAVX2()
+	{
+#if defined(GRIDBATCH_AVX2)
+		constexpr size_t Lanes = 16;
+		const size_t count = size() - size() % Lanes;
+		const __m256i full = _mm256_set1_epi16(Bitboard::FullMask);
+		const __m256i one = _mm256_set1_epi16(1);
+		for (size_t i = 0; i < count; i += Lanes)
+		{
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mX[i]));
+			const __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mO[i]));
+			__m256i xWon = _mm256_setzero_si256();
+			__m256i oWon = _mm256_setzero_si256();
+			for (uint16_t line : Bitboard::WinMasks)
+			{
+				const __m256i mask = _mm256_set1_epi16(static_cast<short>(line));
+				xWon = _mm256_or_si256(xWon, _mm256_cmpeq_epi16(_mm256_and_si256(x, mask), mask));
+				oWon = _mm256_or_si256(oWon, _mm256_cmpeq_epi16(_mm256_and_si256(o, mask), mask));
+			}
+			// Case::X is 1 and Case::O is 2 : X lanes get 1, O lanes get 2
+			const __m256i winner = _mm256_or_si256(_mm256_and_si256(xWon, one), _mm256_and_si256(_mm256_andnot_si256(xWon, oWon), _mm256_add_epi16(one, one)));
+			const __m256i occupied = _mm256_or_si256(x, o);
+			const __m256i finished = _mm256_or_si256(_mm256_or_si256(xWon, oWon), _mm256_cmpeq_epi16(occupied, full));
+			const __m256i legal = _mm256_andnot_si256(finished, _mm256_andnot_si256(occupied, full));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&mLegalMoves[i]), legal);
+			// Narrow 16 bits lanes to bytes : packus works per 128 bits half, both halves go in the low 8 bytes of each
+			const __m128i winnerBytes = _mm_packus_epi16(_mm256_castsi256_si128(winner), _mm256_extracti128_si256(winner, 1));
+			const __m256i finishedOne = _mm256_and_si256(finished, one);
+			const __m128i finishedBytes = _mm_packus_epi16(_mm256_castsi256_si128(finishedOne), _mm256_extracti128_si256(finishedOne, 1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&mWinners[i]), winnerBytes);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&mFinished[i]), finishedBytes);
+		}
+		return count;
+#else
+		return evaluateSSE2();
+#endif
+	}
+}
\ No newline at end of file
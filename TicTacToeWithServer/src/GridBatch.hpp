@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TicTacToe
+{
+	// Structure of arrays of many 3x3 grids, stored as side by side bitboards
+	// evaluate() computes winner, finished flag and legal moves of all grids at once :
+	// 16 grids per instruction with AVX2, 8 with SSE2, one at a time with the scalar fallback
+	class GridBatch
+	{
+	public:
+		enum class Kernel
+		{
+			Scalar,
+			SSE2,
+			AVX2,
+		};
+		// Best kernel this build and this CPU support
+		static Kernel BestKernel();
+		static const char* KernelName(Kernel kernel);
+
+	public:
+		GridBatch() = default;
+		~GridBatch() = default;
+
+		void reserve(size_t capacity);
+		void clear();
+		size_t size() const { return mX.size(); }
+
+		void add(const Grid& grid) { add(grid.bitboard(Case::X), grid.bitboard(Case::O)); }
+		void add(uint16_t x, uint16_t o);
+
+		// Fill results of all grids. Requesting a kernel the build or the CPU lacks falls back to SSE2, then to scalar.
+		void evaluate() { evaluate(BestKernel()); }
+		void evaluate(Kernel kernel);
+
+		// Results of the last evaluate()
+		Case winner(size_t index) const { return static_cast<Case>(mWinners[index]); }
+		bool isFinished(size_t index) const { return mFinished[index] != 0; }
+		// Free cases of a running grid, 0 once finished
+		uint16_t legalMoves(size_t index) const { return mLegalMoves[index]; }
+
+		const std::vector<uint8_t>& winners() const { return mWinners; }
+		const std::vector<uint8_t>& finished() const { return mFinished; }
+		const std::vector<uint16_t>& legalMoves() const { return mLegalMoves; }
+
+	private:
+		void evaluateScalar(size_t begin, size_t end);
+		// SIMD kernels handle whole registers only. Return the number of grids evaluated, the caller finishes the tail.
+		size_t evaluateSSE2();
+		size_t evaluateAVX2();
+
+	private:
+		std::vector<uint16_t> mX;
+		std::vector<uint16_t> mO;
+		std::vector<uint8_t> mWinners;
+		std::vector<uint8_t> mFinished;
+		std::vector<uint16_t> mLegalMoves;
+	};
+}
\ No newline at end of file
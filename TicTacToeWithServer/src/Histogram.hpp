@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Log-linear histogram of unsigned values
+// Each power of two is split in SubBuckets buckets : percentiles are within 25% of the real value over the whole uint64 range
+// Fixed size, no allocation : cheap to copy and merge across threads
+class Histogram
+{
+public:
+	static constexpr unsigned int SubBucketsBits = 2;
+	static constexpr unsigned int SubBuckets = 1u << SubBucketsBits;
+	static constexpr unsigned int BucketsCount = (64 - SubBucketsBits + 1) * SubBuckets;
+
+	static constexpr unsigned int BucketOf(uint64_t value)
+	{
+		if (value < SubBuckets)
+			return static_cast<unsigned int>(value);
+		unsigned int msb = 0;
+		for (unsigned int step = 32; step; step /= 2)
+		{
+			if (value >> (msb + step))
+				msb += step;
+		}
+		const unsigned int shift = msb - SubBucketsBits;
+		return (shift + 1) * SubBuckets + static_cast<unsigned int>((value >> shift) - SubBuckets);
+	}
+	// Greatest value stored in given bucket
+	static constexpr uint64_t BucketMax(unsigned int bucket)
+	{
+		if (bucket < SubBuckets)
+			return bucket;
+		const unsigned int shift = bucket / SubBuckets - 1;
+		const uint64_t lower = static_cast<uint64_t>(SubBuckets + bucket % SubBuckets) << shift;
+		return lower + ((uint64_t(1) << shift) - 1);
+	}
+
+public:
+	void add(uint64_t value)
+	{
+		++mBuckets[BucketOf(value)];
+		++mCount;
+		mSum += value;
+		if (value > mMax)
+			mMax = value;
+	}
+	// Add value count times
+	void add(uint64_t value, uint64_t count)
+	{
+		if (!count)
+			return;
+		mBuckets[BucketOf(value)] += count;
+		mCount += count;
+		mSum += value * count;
+		if (value > mMax)
+			mMax = value;
+	}
+	void merge(const Histogram& other)
+	{
+		for (unsigned int i = 0; i < BucketsCount; ++i)
+			mBuckets[i] += other.mBuckets[i];
+		mCount += other.mCount;
+		mSum += other.mSum;
+		if (other.mMax > mMax)
+			mMax = other.mMax;
+	}
+	void clear() { *this = Histogram(); }
+
+	uint64_t count() const { return mCount; }
+	uint64_t max() const { return mMax; }
+	double mean() const { return mCount ? static_cast<double>(mSum) / mCount : 0.; }
+	// Upper bound of the bucket holding given percentile, in [0, 100]
+	uint64_t percentile(double percent) const
+	{
+		if (!mCount)
+			return 0;
+		const uint64_t rank = static_cast<uint64_t>(percent / 100. * (mCount - 1)) + 1;
+		uint64_t seen = 0;
+		for (unsigned int i = 0; i < BucketsCount; ++i)
+		{
+			seen += mBuckets[i];
+			if (seen >= rank)
+				return BucketMax(i) < mMax ? BucketMax(i) : mMax;
+		}
+		return mMax;
+	}
+	uint64_t bucket(unsigned int index) const { return mBuckets[index]; }
+
+private:
+	std::array<uint64_t, BucketsCount> mBuckets{};
+	uint64_t mCount{ 0 };
+	uint64_t mSum{ 0 };
+	uint64_t mMax{ 0 };
+};
\ No newline at end of file
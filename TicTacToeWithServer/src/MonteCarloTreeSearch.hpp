@@ -0,0 +1,352 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace TicTacToe
+{
+	// Monte Carlo Tree Search for any BasicGrid, for grids too large for an exhaustive search
+	// Tree parallelism : all threads walk the same tree, a virtual loss pushes them apart while a playout is in flight
+	// Nodes come from a pool allocated once at construction and playouts run on a copy of the grid kept on the stack,
+	// so searching never touches the heap
+	template<class GridType>
+	class MonteCarloTreeSearch
+	{
+	public:
+		static constexpr unsigned int Width = GridType::Width;
+		static constexpr unsigned int Height = GridType::Height;
+		static constexpr unsigned int CasesCount = Width * Height;
+
+		struct Limits
+		{
+			// Wall clock budget for the whole move
+			std::chrono::milliseconds budget{ 1000 };
+			uint64_t maxPlayouts{ UINT64_MAX };
+			// Main thread included
+			unsigned int threads{ std::max(1u, std::thread::hardware_concurrency()) };
+		};
+		struct Report
+		{
+			unsigned int x{ 0 };
+			unsigned int y{ 0 };
+			// Average result of the chosen move for player, from 0 (always lost) to 1 (always won)
+			double winRate{ 0. };
+			uint64_t playouts{ 0 };
+			std::chrono::microseconds elapsed{ 0 };
+			// Nodes taken from the pool, and the memory they use
+			size_t nodesCount{ 0 };
+			size_t treeMemory{ 0 };
+
+			double playoutsPerSecond() const { return elapsed.count() > 0 ? playouts * 1000000. / elapsed.count() : 0.; }
+		};
+
+	public:
+		explicit MonteCarloTreeSearch(size_t maxNodes = 1 << 20);
+		~MonteCarloTreeSearch() = default;
+
+		// Search the best move for player within limits. Return false if there is no move to play, true otherwise.
+		bool search(const GridType& grid, Case player, const Limits& limits, Report& report);
+
+		// Memory reserved by the node pool
+		size_t poolMemory() const { return mCapacity * sizeof(Node); }
+
+	private:
+		enum class NodeState : uint8_t
+		{
+			Leaf,
+			Expanding,
+			Expanded,
+			// Pool exhausted : stays a leaf
+			Full,
+		};
+		struct Node
+		{
+			// Visits include in flight playouts (virtual losses)
+			std::atomic<uint32_t> visits{ 0 };
+			// 2 per win, 1 per draw, for the player who played move
+			std::atomic<uint32_t> score{ 0 };
+			std::atomic<uint32_t> firstChild{ 0 };
+			std::atomic<uint16_t> childrenCount{ 0 };
+			std::atomic<NodeState> state{ NodeState::Leaf };
+			// Case index x * Height + y
+			uint16_t move{ 0 };
+		};
+		using Moves = std::array<uint16_t, CasesCount>;
+		// xorshift64 : cheap and good enough for random playouts
+		struct Random
+		{
+			uint64_t state;
+			uint32_t next(uint32_t bound)
+			{
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				return static_cast<uint32_t>((state >> 32) * bound >> 32);
+			}
+		};
+
+		// One selection, expansion, playout and backpropagation
+		void iterate(const GridType& grid, Case player, Random& random);
+		void expand(Node& node, const GridType& grid);
+		// Child of node with the best UCT score
+		uint32_t select(const Node& node) const;
+		// Play random moves until the game is over and return the winner
+		static Case playout(GridType& grid, Case player, Random& random);
+		// Fill moves with cases worth playing. Return moves count.
+		static unsigned int generateMoves(const GridType& grid, Moves& moves);
+		static Case Opponent(Case player) { return player == Case::X ? Case::O : Case::X; }
+
+	private:
+		static constexpr uint32_t VirtualLoss = 3;
+		static constexpr double Exploration = 1.41421356;
+
+		std::unique_ptr<Node[]> mNodes;
+		size_t mCapacity;
+		std::atomic<uint32_t> mNextNode{ 1 };
+		std::atomic<uint64_t> mPlayouts{ 0 };
+		std::atomic<bool> mStop{ false };
+	};
+
+	template<class GridType>
+	MonteCarloTreeSearch<GridType>::MonteCarloTreeSearch(size_t maxNodes)
+		: mNodes(std::make_unique<Node[]>(std::max<size_t>(maxNodes, 1)))
+		, mCapacity(std::max<size_t>(maxNodes, 1))
+	{}
+
+	template<class GridType>
+	bool MonteCarloTreeSearch<GridType>::search(const GridType& grid, Case player, const Limits& limits, Report& report)
+	{
+		if (grid.isFinished() || player == Case::Empty)
+			return false;
+
+		// Recycle the whole pool : only the root is kept
+		Node& root = mNodes[0];
+		root.visits = 0;
+		root.score = 0;
+		root.childrenCount = 0;
+		root.state = NodeState::Leaf;
+		mNextNode = 1;
+		mPlayouts = 0;
+		mStop = false;
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto deadline = start + limits.budget;
+		auto runThread = [&](unsigned int threadIndex)
+		{
+			Random random{ 0x9E3779B97F4A7C15ull * (threadIndex + 1) };
+			uint64_t playouts = 0;
+			while (!mStop.load(std::memory_order_relaxed))
+			{
+				iterate(grid, player, random);
+				++playouts;
+				// Checking the clock is way more expensive than a short playout : only do it from time to time
+				if ((playouts & 63) == 0)
+				{
+					const uint64_t total = mPlayouts.fetch_add(64, std::memory_order_relaxed) + 64;
+					if (total >= limits.maxPlayouts || std::chrono::steady_clock::now() >= deadline)
+						mStop = true;
+				}
+			}
+			mPlayouts.fetch_add(playouts & 63, std::memory_order_relaxed);
+		};
+		std::vector<std::thread> helpers;
+		for (unsigned int i = 1; i < std::max(limits.threads, 1u); ++i)
+			helpers.emplace_back(runThread, i);
+		runThread(0);
+		for (std::thread& helper : helpers)
+			helper.join();
+
+		report.playouts = mPlayouts;
+		report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+		report.nodesCount = std::min<size_t>(mNextNode, mCapacity);
+		report.treeMemory = report.nodesCount * sizeof(Node);
+		if (root.state != NodeState::Expanded)
+			return false;
+		// Most visited move is the most robust choice
+		const Node* best = nullptr;
+		for (uint32_t i = 0; i < root.childrenCount; ++i)
+		{
+			const Node& child = mNodes[root.firstChild + i];
+			if (!best || child.visits > best->visits)
+				best = &child;
+		}
+		report.x = best->move / Height;
+		report.y = best->move % Height;
+		report.winRate = best->visits ? best->score / (2. * best->visits) : 0.;
+		return true;
+	}
+
+	template<class GridType>
+	void MonteCarloTreeSearch<GridType>::iterate(const GridType& grid, Case player, Random& random)
+	{
+		// Nodes walked and who played their move
+		std::array<uint32_t, CasesCount + 1> path;
+		std::array<Case, CasesCount + 1> movers;
+		unsigned int depth = 0;
+
+		GridType board = grid;
+		Case toPlay = player;
+		uint32_t nodeIndex = 0;
+		movers[0] = Opponent(player);
+		while (true)
+		{
+			Node& node = mNodes[nodeIndex];
+			path[depth] = nodeIndex;
+			const uint32_t previousVisits = node.visits.fetch_add(VirtualLoss, std::memory_order_relaxed);
+			if (board.isFinished())
+				break;
+			NodeState state = node.state.load(std::memory_order_acquire);
+			if (state == NodeState::Leaf && (previousVisits > 0 || nodeIndex == 0)
+				&& node.state.compare_exchange_strong(state, NodeState::Expanding, std::memory_order_acquire))
+			{
+				expand(node, board);
+				state = node.state.load(std::memory_order_relaxed);
+			}
+			if (state != NodeState::Expanded)
+				break;
+			nodeIndex = select(node);
+			const uint16_t move = mNodes[nodeIndex].move;
+			board.play(move / Height, move % Height, toPlay);
+			++depth;
+			movers[depth] = toPlay;
+			toPlay = Opponent(toPlay);
+		}
+
+		const Case winner = board.isFinished() ? board.winner() : playout(board, toPlay, random);
+		for (unsigned int i = 0; i <= depth; ++i)
+		{
+			Node& node = mNodes[path[i]];
+			const uint32_t score = winner == movers[i] ? 2 : (winner == Case::Empty ? 1 : 0);
+			node.score.fetch_add(score, std::memory_order_relaxed);
+			node.visits.fetch_sub(VirtualLoss - 1, std::memory_order_relaxed);
+		}
+	}
+
+	template<class GridType>
+	void MonteCarloTreeSearch<GridType>::expand(Node& node, const GridType& grid)
+	{
+		Moves moves;
+		const unsigned int movesCount = generateMoves(grid, moves);
+		const uint32_t first = mNextNode.fetch_add(movesCount, std::memory_order_relaxed);
+		if (movesCount == 0 || first + movesCount > mCapacity)
+		{
+			node.state.store(NodeState::Full, std::memory_order_release);
+			return;
+		}
+		for (unsigned int i = 0; i < movesCount; ++i)
+		{
+			Node& child = mNodes[first + i];
+			child.visits.store(0, std::memory_order_relaxed);
+			child.score.store(0, std::memory_order_relaxed);
+			child.childrenCount.store(0, std::memory_order_relaxed);
+			child.state.store(NodeState::Leaf, std::memory_order_relaxed);
+			child.move = moves[i];
+		}
+		node.firstChild.store(first, std::memory_order_relaxed);
+		node.childrenCount.store(static_cast<uint16_t>(movesCount), std::memory_order_relaxed);
+		node.state.store(NodeState::Expanded, std::memory_order_release);
+	}
+
+	template<class GridType>
+	uint32_t MonteCarloTreeSearch<GridType>::select(const Node& node) const
+	{
+		const uint32_t first = node.firstChild.load(std::memory_order_relaxed);
+		const uint16_t count = node.childrenCount.load(std::memory_order_relaxed);
+		const double logVisits = std::log(static_cast<double>(std::max(node.visits.load(std::memory_order_relaxed), 1u)));
+		uint32_t best = first;
+		double bestScore = -1.;
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			const Node& child = mNodes[i];
+			const uint32_t visits = child.visits.load(std::memory_order_relaxed);
+			if (visits == 0)
+				return i;
+			const double exploitation = child.score.load(std::memory_order_relaxed) / (2. * visits);
+			const double score = exploitation + Exploration * std::sqrt(logVisits / visits);
+			if (score > bestScore)
+			{
+				bestScore = score;
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	template<class GridType>
+	Case MonteCarloTreeSearch<GridType>::playout(GridType& grid, Case player, Random& random)
+	{
+		Moves freeCases;
+		unsigned int freeCount = 0;
+		const auto& cases = grid.grid();
+		for (unsigned int x = 0; x < Width; ++x)
+		{
+			for (unsigned int y = 0; y < Height; ++y)
+			{
+				if (cases[x][y] == Case::Empty)
+					freeCases[freeCount++] = static_cast<uint16_t>(x * Height + y);
+			}
+		}
+		while (!grid.isFinished() && freeCount > 0)
+		{
+			// Pick a random free case and remove it by swapping with the last one
+			const uint32_t pick = random.next(freeCount);
+			const uint16_t move = freeCases[pick];
+			freeCases[pick] = freeCases[--freeCount];
+			grid.play(move / Height, move % Height, player);
+			player = Opponent(player);
+		}
+		return grid.winner();
+	}
+
+	template<class GridType>
+	unsigned int MonteCarloTreeSearch<GridType>::generateMoves(const GridType& grid, Moves& moves)
+	{
+		// On large grids only cases close to existing stones are worth exploring
+		constexpr int Radius = 2;
+		const auto& cases = grid.grid();
+		std::array<bool, CasesCount> candidates{};
+		bool hasStone = false;
+		for (unsigned int x = 0; x < Width; ++x)
+		{
+			for (unsigned int y = 0; y < Height; ++y)
+			{
+				if (cases[x][y] == Case::Empty)
+				{
+					// Small grids : every free case is a candidate
+					candidates[x * Height + y] |= CasesCount <= 25;
+					continue;
+				}
+				hasStone = true;
+				for (int cx = std::max(0, static_cast<int>(x) - Radius); cx <= std::min(static_cast<int>(Width) - 1, static_cast<int>(x) + Radius); ++cx)
+				{
+					for (int cy = std::max(0, static_cast<int>(y) - Radius); cy <= std::min(static_cast<int>(Height) - 1, static_cast<int>(y) + Radius); ++cy)
+					{
+						if (cases[cx][cy] == Case::Empty)
+							candidates[cx * Height + cy] = true;
+					}
+				}
+			}
+		}
+		if (!hasStone && CasesCount > 25)
+		{
+			moves[0] = static_cast<uint16_t>((Width / 2) * Height + Height / 2);
+			return 1;
+		}
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < CasesCount; ++i)
+		{
+			if (candidates[i])
+				moves[count++] = static_cast<uint16_t>(i);
+		}
+		return count;
+	}
+}
\ No newline at end of file
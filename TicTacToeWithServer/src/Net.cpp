@@ -17,13 +17,184 @@ namespace TicTacToe
 				&& stream.read(y);
 		}
 
-		//bool Start::write(Bousk::Serialization::Serializer& stream) const
-		//{
-		//	return stream.write(symbol);
-		//}
-		//bool Start::read(Bousk::Serialization::Deserializer& stream)
-		//{
-		//	return stream.read(symbol);
-		//}
+		bool Start::write(Bousk::Serialization::Serializer& stream) const
+		{
+			if (symbol == Case::Empty)
+				return false;
+			Bousk::RangedInteger<1, 2> value;
+			value = static_cast<uint8_t>(symbol);
+			return stream.write(value);
+		}
+		bool Start::read(Bousk::Serialization::Deserializer& stream)
+		{
+			Bousk::RangedInteger<1, 2> value;
+			if (!stream.read(value))
+				return false;
+			symbol = static_cast<Case>(value.get());
+			return true;
+		}
+
+		using TypeValue = Bousk::RangedInteger<0, static_cast<int>(LastMessageType)>;
+		bool WriteType(Bousk::Serialization::Serializer& stream, MessageType type)
+		{
+			TypeValue value;
+			value = static_cast<uint8_t>(type);
+			return stream.write(value);
+		}
+		bool ReadType(Bousk::Serialization::Deserializer& stream, MessageType& type)
+		{
+			TypeValue value;
+			if (!stream.read(value))
+				return false;
+			type = static_cast<MessageType>(value.get());
+			return true;
+		}
+
+		bool Play::encode(BitWriter& stream) const
+		{
+			return stream.write(static_cast<uint32_t>(x.get()) * 3 + y.get(), Bits);
+		}
+		bool Play::decode(BitReader& stream)
+		{
+			uint32_t index;
+			if (!stream.read(index, Bits) || index >= 9)
+				return false;
+			x = static_cast<uint8_t>(index / 3);
+			y = static_cast<uint8_t>(index % 3);
+			return true;
+		}
+
+		bool Start::encode(BitWriter& stream) const
+		{
+			if (symbol == Case::Empty)
+				return false;
+			return stream.write(symbol == Case::X ? 0 : 1, Bits);
+		}
+		bool Start::decode(BitReader& stream)
+		{
+			uint32_t value;
+			if (!stream.read(value, Bits))
+				return false;
+			symbol = value ? Case::O : Case::X;
+			return true;
+		}
+
+		Snapshot Snapshot::Of(const Grid& grid)
+		{
+			Snapshot snapshot;
+			const uint16_t x = grid.bitboard(Case::X);
+			const uint16_t o = grid.bitboard(Case::O);
+			for (unsigned int i = 0; i < 9; ++i)
+			{
+				if (x & (1u << i))
+					snapshot.board |= static_cast<uint32_t>(Case::X) << (2 * i);
+				else if (o & (1u << i))
+					snapshot.board |= static_cast<uint32_t>(Case::O) << (2 * i);
+			}
+			return snapshot;
+		}
+		bool Snapshot::encode(BitWriter& stream) const
+		{
+			return stream.write(board, Bits);
+		}
+		bool Snapshot::decode(BitReader& stream)
+		{
+			if (!stream.read(board, Bits))
+				return false;
+			// 3 is not a valid case
+			for (unsigned int i = 0; i < 9; ++i)
+			{
+				if (((board >> (2 * i)) & 3) == 3)
+					return false;
+			}
+			return true;
+		}
+
+		bool Snapshot::restore(Grid& grid) const
+		{
+			uint16_t x = 0;
+			uint16_t o = 0;
+			for (unsigned int i = 0; i < 9; ++i)
+			{
+				const Case owner = static_cast<Case>((board >> (2 * i)) & 3);
+				if (owner == Case::X)
+					x |= static_cast<uint16_t>(1u << i);
+				else if (owner == Case::O)
+					o |= static_cast<uint16_t>(1u << i);
+			}
+			return grid.reset(x, o);
+		}
+
+		bool Delta::encode(BitWriter& stream) const
+		{
+			if (sequence < 1 || sequence > 9)
+				return false;
+			return stream.write(sequence - 1u, 4)
+				&& stream.write(static_cast<uint32_t>(x.get()) * 3 + y.get(), 4);
+		}
+		bool Delta::decode(BitReader& stream)
+		{
+			uint32_t value;
+			uint32_t index;
+			if (!stream.read(value, 4) || value >= 9 || !stream.read(index, 4) || index >= 9)
+				return false;
+			sequence = static_cast<uint8_t>(value + 1);
+			x = static_cast<uint8_t>(index / 3);
+			y = static_cast<uint8_t>(index % 3);
+			return true;
+		}
+
+		bool Hello::encode(BitWriter& stream) const
+		{
+			return stream.write(version, Bits);
+		}
+		bool Hello::decode(BitReader& stream)
+		{
+			uint32_t value;
+			if (!stream.read(value, Bits))
+				return false;
+			version = static_cast<uint8_t>(value);
+			return true;
+		}
+
+		bool Seat::encode(BitWriter& stream) const
+		{
+			return stream.write(player, 32)
+				&& stream.write(generation, 32)
+				&& stream.write(key, 32);
+		}
+		bool Seat::decode(BitReader& stream)
+		{
+			return stream.read(player, 32)
+				&& stream.read(generation, 32)
+				&& stream.read(key, 32);
+		}
+
+		bool Rejoin::encode(BitWriter& stream) const
+		{
+			return stream.write(version, Hello::Bits)
+				&& seat.encode(stream);
+		}
+		bool Rejoin::decode(BitReader& stream)
+		{
+			uint32_t value;
+			if (!stream.read(value, Hello::Bits))
+				return false;
+			version = static_cast<uint8_t>(value);
+			return seat.decode(stream);
+		}
+
+		bool Spectate::encode(BitWriter& stream) const
+		{
+			return stream.write(version, Bits);
+		}
+		bool Spectate::decode(BitReader& stream)
+		{
+			uint32_t value;
+			if (!stream.read(value, Bits))
+				return false;
+			version = static_cast<uint8_t>(value);
+			return true;
+		}
 	}
 }
\ No newline at end of file
@@ -2,8 +2,12 @@
 
 #include <RangedInteger.hpp>
 
+#include <BitStream.hpp>
 #include <Game.hpp>
 
+#include <cstddef>
+#include <cstdint>
+
 namespace Bousk
 {
 	namespace Serialization
@@ -16,21 +20,268 @@ namespace TicTacToe
 {
 	namespace Net
 	{
+		// Protocol version, exchanged in Hello when connecting to a server
+		constexpr uint8_t ProtocolVersion = 4;
+
+		enum class MessageType : uint8_t
+		{
+			Play,
+			Start,
+			Snapshot,
+			Hello,
+			Delta,
+			Resync,
+			Spectate,
+			Ping,
+			Pong,
+			Seat,
+			Rejoin,
+		};
+		// Keep it the last enumerator : encodings size their type field after it
+		constexpr MessageType LastMessageType = MessageType::Rejoin;
+
+		// Compact encoding : a packet is a sequence of messages, each one a 4 bits id followed by its bit packed payload
+		// Id 0 ends the packet, so the zero padding of the last byte needs no length
+		constexpr unsigned int MessageIdBits = 4;
+		constexpr uint32_t EndOfPacketId = 0;
+		constexpr uint32_t IdOf(MessageType type) { return static_cast<uint32_t>(type) + 1; }
+		static_assert(IdOf(LastMessageType) < (1u << MessageIdBits), "Message ids don't fit MessageIdBits");
+
+		// How a message travels. A packet only holds messages of one delivery.
+		enum class Delivery : uint8_t
+		{
+			// Retransmitted until acknowledged, delivered in order : game state
+			Reliable,
+			// Never retransmitted nor held back by a lost one, dropped when older than the last received : ephemeral data
+			Sequenced,
+		};
+
 		struct Play
 		{
+			static constexpr MessageType Type = MessageType::Play;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			// Case index x * 3 + y
+			static constexpr unsigned int Bits = 4;
+
 			Bousk::RangedInteger<0, 2> x;
 			Bousk::RangedInteger<0, 2> y;
 			
 			bool write(Bousk::Serialization::Serializer&) const;
 			bool read(Bousk::Serialization::Deserializer&);
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
 		};
 
-		//struct Start
-		//{
-		//	Case symbol;
+		// Sent by the server to each player of a new match
+		struct Start
+		{
+			static constexpr MessageType Type = MessageType::Start;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = 1;
+
+			Case symbol{ Case::X };
+
+			bool write(Bousk::Serialization::Serializer&) const;
+			bool read(Bousk::Serialization::Deserializer&);
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// Whole board, 2 bits per case
+		// Sent by the server on Resync. Its sequence is the number of played cases : deltas follow from there.
+		struct Snapshot
+		{
+			static constexpr MessageType Type = MessageType::Snapshot;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = 18;
+
+			// Case (x, y) in bits 2 * (x * 3 + y) and the next one, valued as Case
+			uint32_t board{ 0 };
+
+			static Snapshot Of(const Grid& grid);
+			Case at(unsigned int x, unsigned int y) const { return static_cast<Case>((board >> (2 * (x * 3 + y))) & 3); }
+			// Replace grid by the snapshot position. Return false if it's not a reachable one.
+			bool restore(Grid& grid) const;
+
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// First message of a client to the server
+		struct Hello
+		{
+			static constexpr MessageType Type = MessageType::Hello;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = 4;
+
+			uint8_t version{ ProtocolVersion };
+
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// First message of a spectator to the server, instead of Hello : it then receives the featured match deltas
+		struct Spectate
+		{
+			static constexpr MessageType Type = MessageType::Spectate;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = Hello::Bits;
+
+			uint8_t version{ ProtocolVersion };
+
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// Move played in a match, sent by the server
+		// sequence is the number of played cases once it's applied : a client missing one sees a gap and asks for a Resync
+		struct Delta
+		{
+			static constexpr MessageType Type = MessageType::Delta;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			// Sequence 1 to 9, then case index x * 3 + y
+			static constexpr unsigned int Bits = 8;
+
+			uint8_t sequence{ 1 };
+			Bousk::RangedInteger<0, 2> x;
+			Bousk::RangedInteger<0, 2> y;
 
-		//	bool write(Bousk::Serialization::Serializer&) const;
-		//	bool read(Bousk::Serialization::Deserializer&);
-		//};
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// Sent by a client out of sync with its match, or joining it, to get a Snapshot
+		struct Resync
+		{
+			static constexpr MessageType Type = MessageType::Resync;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = 0;
+
+			bool encode(BitWriter&) const { return true; }
+			bool decode(BitReader&) { return true; }
+		};
+
+		// Sent by the server with Start : what the player presents in Rejoin to get its seat back if its connection drops
+		struct Seat
+		{
+			static constexpr MessageType Type = MessageType::Seat;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = 96;
+
+			// Server handle of the player, and a random key so it can't be guessed
+			uint32_t player{ 0 };
+			uint32_t generation{ 0 };
+			uint32_t key{ 0 };
+
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// First message of a client reconnecting during its match, instead of Hello : the server answers with a Snapshot
+		// A seat no longer kept is no error : the client is then queued for a new match, as with Hello
+		struct Rejoin
+		{
+			static constexpr MessageType Type = MessageType::Rejoin;
+			static constexpr Delivery DeliveryMode = Delivery::Reliable;
+			static constexpr unsigned int Bits = Hello::Bits + Seat::Bits;
+
+			uint8_t version{ ProtocolVersion };
+			Seat seat;
+
+			bool encode(BitWriter&) const;
+			bool decode(BitReader&);
+		};
+
+		// Round-trip time probe, answered right away with a Pong carrying the same stamp
+		// Exchanged by NetService in datagrams of their own : listeners never see them
+		// Sequenced : a lost one is a lost one, and no retransmission nor reliable traffic delays the others
+		struct Ping
+		{
+			static constexpr MessageType Type = MessageType::Ping;
+			static constexpr Delivery DeliveryMode = Delivery::Sequenced;
+			// Microseconds on the sender clock, wrapping : only differences are meaningful
+			static constexpr unsigned int Bits = 32;
+
+			uint32_t stamp{ 0 };
+
+			bool encode(BitWriter& stream) const { return stream.write(stamp, Bits); }
+			bool decode(BitReader& stream) { return stream.read(stamp, Bits); }
+		};
+		struct Pong
+		{
+			static constexpr MessageType Type = MessageType::Pong;
+			static constexpr Delivery DeliveryMode = Delivery::Sequenced;
+			static constexpr unsigned int Bits = Ping::Bits;
+
+			uint32_t stamp{ 0 };
+
+			bool encode(BitWriter& stream) const { return stream.write(stamp, Bits); }
+			bool decode(BitReader& stream) { return stream.read(stamp, Bits); }
+		};
+
+		// Pack several messages in one datagram
+		class PacketWriter
+		{
+		public:
+			PacketWriter(uint8_t* buffer, size_t capacity)
+				: mWriter(buffer, capacity)
+			{}
+
+			// Return false if the message doesn't fit or can't be encoded, the packet is then left as it was
+			template<class Message>
+			bool write(const Message& message)
+			{
+				if (mWriter.remainingBits() < MessageIdBits + Message::Bits)
+					return false;
+				const size_t start = mWriter.bitsCount();
+				if (mWriter.write(IdOf(Message::Type), MessageIdBits) && message.encode(mWriter))
+					return true;
+				// Drop the id, and what encode wrote before failing : readers would take them for a message
+				mWriter.rewind(start);
+				return false;
+			}
+			void clear() { mWriter.clear(); }
+
+			bool empty() const { return mWriter.bitsCount() == 0; }
+			const uint8_t* data() const { return mWriter.data(); }
+			size_t size() const { return mWriter.size(); }
+
+		private:
+			BitWriter mWriter;
+		};
+		class PacketReader
+		{
+		public:
+			PacketReader(const uint8_t* data, size_t size)
+				: mReader(data, size)
+			{}
+
+			// Read the type of the next message. Return false at the end of the packet.
+			bool next(MessageType& type)
+			{
+				uint32_t id;
+				if (!mReader.read(id, MessageIdBits) || id == EndOfPacketId || id > IdOf(LastMessageType))
+					return false;
+				type = static_cast<MessageType>(id - 1);
+				return true;
+			}
+			// Read the payload of the message returned by next()
+			template<class Message>
+			bool read(Message& message) { return message.decode(mReader); }
+
+		private:
+			BitReader mReader;
+		};
+
+		// Bousk Serializer encoding, message preceded by its type
+		// Reference of the protocol benchmark : the legacy peer to peer mode serializes its Play messages without any type
+		bool WriteType(Bousk::Serialization::Serializer&, MessageType type);
+		bool ReadType(Bousk::Serialization::Deserializer&, MessageType& type);
+		template<class Message>
+		bool Write(Bousk::Serialization::Serializer& stream, const Message& message)
+		{
+			return WriteType(stream, Message::Type)
+				&& message.write(stream);
+		}
 	}
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include <Sockets.hpp>
 #include <UDP/Protocols/ReliableOrdered.hpp>
+#include <UDP/Protocols/UnreliableOrdered.hpp>
+
+#include <algorithm>
 
 #define FORWARD_TO_LISTENERS(ListenerMethod, ...)	\
 	for (IListener* listener : mListeners)			\
@@ -9,9 +12,71 @@
 		listener->ListenerMethod(__VA_ARGS__);		\
 	}
 
+namespace
+{
+	// Telemetry has a single writer : relaxed load then store, no locked read-modify-write
+	template<class T, class Value>
+	void Add(std::atomic<T>& counter, Value value)
+	{
+		counter.store(static_cast<T>(counter.load(std::memory_order_relaxed) + value), std::memory_order_relaxed);
+	}
+	template<class T, class Value>
+	void Store(std::atomic<T>& counter, Value value)
+	{
+		counter.store(static_cast<T>(value), std::memory_order_relaxed);
+	}
+	template<class T>
+	T Load(const std::atomic<T>& counter)
+	{
+		return counter.load(std::memory_order_relaxed);
+	}
+}
+
+const std::array<NetService::Dispatcher, static_cast<size_t>(NetService::IncomingType::Ignored) + 1> NetService::Dispatchers
+{
+	[](NetService& service, const Bousk::Network::Messages::Base& msg)
+	{
+		// Only host can accept connections. Clients will silently ignore them.
+		if (!service.isHost())
+			return;
+		bool acceptConnection = true;
+		for (IListener* listener : service.mListeners)
+		{
+			acceptConnection &= listener->onIncomingConnection(static_cast<const Bousk::Network::Messages::IncomingConnection&>(msg));
+		}
+		if (acceptConnection)
+			service.mUdpClient.connect(msg.emitter());
+	},
+	[](NetService& service, const Bousk::Network::Messages::Base& msg)
+	{
+		const Bousk::Network::Messages::Connection& connection = static_cast<const Bousk::Network::Messages::Connection&>(msg);
+		if (connection.result == Bousk::Network::Messages::Connection::Result::Success)
+			service.openConnection(connection.emitter());
+		for (IListener* listener : service.mListeners)
+			listener->onConnectionResult(connection);
+	},
+	[](NetService& service, const Bousk::Network::Messages::Base& msg)
+	{
+		for (IListener* listener : service.mListeners)
+			listener->onDisconnection(static_cast<const Bousk::Network::Messages::Disconnection&>(msg));
+		service.closeConnection(msg.emitter());
+	},
+	[](NetService& service, const Bousk::Network::Messages::Base& msg)
+	{
+		const Bousk::Network::Messages::UserData& userData = static_cast<const Bousk::Network::Messages::UserData&>(msg);
+		if (service.onDatagram(userData))
+			return;
+		for (IListener* listener : service.mListeners)
+			listener->onDataReceived(userData);
+	},
+	[](NetService&, const Bousk::Network::Messages::Base&) {},
+};
+
 NetService::NetService()
 {
+	// Same order as Channel
 	mUdpClient.registerChannel<Bousk::Network::UDP::Protocols::ReliableOrdered>();
+	mUdpClient.registerChannel<Bousk::Network::UDP::Protocols::UnreliableOrdered>();
 }
 bool NetService::init(const Parameters& parameters)
 {
@@ -30,6 +95,16 @@ bool NetService::init(const Parameters& parameters)
 			// If we're not host, initialize connection right away
 			mUdpClient.connect(parameters.hostAddress);
 		}
+		mConnectionsCapacity = parameters.maxConnections;
+		mConnections = std::make_unique<Connection[]>(mConnectionsCapacity);
+		mFreeConnections.clear();
+		for (size_t i = mConnectionsCapacity; i > 0; --i)
+			mFreeConnections.push_back(static_cast<uint32_t>(i - 1));
+		mConnectionTable = AddressTable(mConnectionsCapacity);
+		mPendingPings.assign(2 * mConnectionsCapacity, PendingPing());
+		mPingsFront = 0;
+		mPingsCount = 0;
+		mEpoch = std::chrono::steady_clock::now();
 	}
 	mContext = parameters;
 	mState = State::Initialized;
@@ -56,48 +131,331 @@ void NetService::process()
 {
 	if (isInitialized() && isNetworked())
 	{
+		// The library hands out a new container each tick : only move the messages out of it
 		auto messages = mUdpClient.poll();
-		for (const auto& msg : messages)
+		const auto start = std::chrono::steady_clock::now();
+		size_t count = 0;
+		for (auto& msg : messages)
 		{
-			if (msg->is<Bousk::Network::Messages::IncomingConnection>())
+			Incoming& incoming = mIncoming[count];
+			incoming.type = TypeOf(*msg);
+			incoming.message = std::move(msg);
+			if (++count == IncomingCapacity)
 			{
-				if (isHost())
-				{
-					bool acceptConnection = true;
-					// Only host can accept connections. Clients will silently ignore them.
-					for (IListener* listener : mListeners)
-					{
-						acceptConnection &= listener->onIncomingConnection(*(msg->as<Bousk::Network::Messages::IncomingConnection>()));
-					}
-					if (acceptConnection)
-						mUdpClient.connect(msg->emitter());
-				}
-			}
-			else if (msg->is<Bousk::Network::Messages::Connection>())
-			{
-				FORWARD_TO_LISTENERS(onConnectionResult, *(msg->as<Bousk::Network::Messages::Connection>()));
-			}
-			else if (msg->is<Bousk::Network::Messages::UserData>())
-			{
-				FORWARD_TO_LISTENERS(onDataReceived, *(msg->as<Bousk::Network::Messages::UserData>()));
-			}
-			else if (msg->is<Bousk::Network::Messages::Disconnection>())
-			{
-				FORWARD_TO_LISTENERS(onDisconnection, *(msg->as<Bousk::Network::Messages::Disconnection>()));
+				dispatch(count);
+				count = 0;
 			}
 		}
+		dispatch(count);
+		mStatistics.dispatchedMessages += messages.size();
+		mStatistics.dispatchTime += std::chrono::steady_clock::now() - start;
 	}
 }
 void NetService::flush()
 {
-	if (isInitialized() && isNetworked())
+	const bool networked = isInitialized() && isNetworked();
+	if (networked)
+		sendPings();
+	for (std::unique_ptr<SendBuffer>& buffer : mQueuedSendBuffers)
+	{
+		// The library copies data to its own queues, where reliable channels keep it until acknowledged
+		if (networked && !buffer->mWriter.empty())
+		{
+			mUdpClient.sendTo(buffer->mTarget, buffer->mWriter.data(), buffer->mWriter.size(), static_cast<Bousk::uint32>(buffer->mChannel));
+			countSent(buffer->mTarget, buffer->mWriter.size());
+		}
+		buffer->mWriter.clear();
+		mFreeSendBuffers.push_back(std::move(buffer));
+	}
+	mQueuedSendBuffers.clear();
+	if (networked)
+	{
+		for (const SharedSend& send : mSharedSends)
+		{
+			if (!send.buffer->mWriter.empty())
+			{
+				mUdpClient.sendTo(send.target, send.buffer->mWriter.data(), send.buffer->mWriter.size(), static_cast<Bousk::uint32>(send.buffer->mChannel));
+				countSent(send.target, send.buffer->mWriter.size());
+			}
+		}
+	}
+	mSharedSends.clear();
+	for (std::unique_ptr<SendBuffer>& buffer : mSharedSendBuffers)
+	{
+		buffer->mWriter.clear();
+		mFreeSendBuffers.push_back(std::move(buffer));
+	}
+	mSharedSendBuffers.clear();
+	if (networked)
 		mUdpClient.processSend();
+	++mTick;
+}
+
+void NetService::addListener(IListener* listener)
+{
+	if (std::find(mListeners.begin(), mListeners.end(), listener) == mListeners.end())
+		mListeners.push_back(listener);
+}
+void NetService::removeListener(IListener* listener)
+{
+	mListeners.erase(std::remove(mListeners.begin(), mListeners.end(), listener), mListeners.end());
 }
 
-void NetService::sendTo(const Bousk::Network::Address& target, const Bousk::uint8* data, const size_t datasize)
+NetService::IncomingType NetService::TypeOf(const Bousk::Network::Messages::Base& message)
+{
+	// Most frequent first
+	if (message.is<Bousk::Network::Messages::UserData>())
+		return IncomingType::UserData;
+	if (message.is<Bousk::Network::Messages::Connection>())
+		return IncomingType::Connection;
+	if (message.is<Bousk::Network::Messages::IncomingConnection>())
+		return IncomingType::IncomingConnection;
+	if (message.is<Bousk::Network::Messages::Disconnection>())
+		return IncomingType::Disconnection;
+	return IncomingType::Ignored;
+}
+void NetService::dispatch(size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Incoming& incoming = mIncoming[i];
+		Dispatchers[static_cast<size_t>(incoming.type)](*this, *incoming.message);
+		incoming.message.reset();
+	}
+}
+
+void NetService::sendTo(const Bousk::Network::Address& target, const Bousk::uint8* data, const size_t datasize, Channel channel)
 {
 	if (isInitialized() && isNetworked())
-		mUdpClient.sendTo(target, data, datasize, 0);
+	{
+		mUdpClient.sendTo(target, data, datasize, static_cast<Bousk::uint32>(channel));
+		countSent(target, datasize);
+	}
+}
+
+NetService::SendBuffer& NetService::acquireSendBuffer(const Bousk::Network::Address& target, Channel channel)
+{
+	if (mFreeSendBuffers.empty())
+		mFreeSendBuffers.push_back(std::unique_ptr<SendBuffer>(new SendBuffer()));
+	mQueuedSendBuffers.push_back(std::move(mFreeSendBuffers.back()));
+	mFreeSendBuffers.pop_back();
+	SendBuffer& buffer = *mQueuedSendBuffers.back();
+	buffer.mTarget = target;
+	buffer.mChannel = channel;
+	return buffer;
+}
+NetService::SendBuffer& NetService::acquireSharedBuffer(Channel channel)
+{
+	if (mFreeSendBuffers.empty())
+		mFreeSendBuffers.push_back(std::unique_ptr<SendBuffer>(new SendBuffer()));
+	mSharedSendBuffers.push_back(std::move(mFreeSendBuffers.back()));
+	mFreeSendBuffers.pop_back();
+	SendBuffer& buffer = *mSharedSendBuffers.back();
+	buffer.mChannel = channel;
+	return buffer;
+}
+void NetService::sendTo(const Bousk::Network::Address& target, const SendBuffer& buffer)
+{
+	mSharedSends.push_back({ target, &buffer });
+}
+
+bool NetService::sampleConnection(size_t index, ConnectionSample& sample) const
+{
+	if (index >= mConnectionsCapacity)
+		return false;
+	const Connection& connection = mConnections[index];
+	const uint32_t generation = connection.generation.load(std::memory_order_acquire);
+	if (generation % 2 == 0)
+		return false;
+	sample.port = Load(connection.port);
+	sample.datagramsIn = Load(connection.datagramsIn);
+	sample.bytesIn = Load(connection.bytesIn);
+	sample.datagramsOut = Load(connection.datagramsOut);
+	sample.bytesOut = Load(connection.bytesOut);
+	sample.queuedDatagrams = Load(connection.queuedDatagrams);
+	sample.maxQueuedDatagrams = Load(connection.maxQueuedDatagrams);
+	sample.pingsSent = Load(connection.pingsSent);
+	sample.pongsReceived = Load(connection.pongsReceived);
+	sample.duplicatePongs = Load(connection.duplicatePongs);
+	sample.smoothedRtt = std::chrono::microseconds(Load(connection.smoothedRtt));
+	sample.rttVariation = std::chrono::microseconds(Load(connection.rttVariation));
+	sample.rtt.clear();
+	for (unsigned int i = 0; i < RttBucketsCount; ++i)
+		sample.rtt.add(Histogram::BucketMax(i), Load(connection.rtt[i]));
+	// The slot was reused meanwhile : values may mix both connections
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return connection.generation.load(std::memory_order_relaxed) == generation;
+}
+
+uint32_t NetService::findConnection(const Bousk::Network::Address& address) const
+{
+	return mConnectionTable.find(address, [this](uint32_t index) -> const Bousk::Network::Address& { return mConnections[index].address; });
+}
+void NetService::openConnection(const Bousk::Network::Address& address)
+{
+	if (mFreeConnections.empty() || findConnection(address) != NoConnection)
+		return;
+	const uint32_t index = mFreeConnections.back();
+	mFreeConnections.pop_back();
+	Connection& connection = mConnections[index];
+	// Samplers reading a value reset below then see the generation changed
+	std::atomic_thread_fence(std::memory_order_release);
+	Store(connection.port, address.port());
+	Store(connection.datagramsIn, 0);
+	Store(connection.bytesIn, 0);
+	Store(connection.datagramsOut, 0);
+	Store(connection.bytesOut, 0);
+	Store(connection.queuedDatagrams, 0);
+	Store(connection.maxQueuedDatagrams, 0);
+	Store(connection.pingsSent, 0);
+	Store(connection.pongsReceived, 0);
+	Store(connection.duplicatePongs, 0);
+	Store(connection.smoothedRtt, 0);
+	Store(connection.rttVariation, 0);
+	for (std::atomic<uint32_t>& bucket : connection.rtt)
+		Store(bucket, 0);
+	connection.address = address;
+	connection.lastSendTick = 0;
+	connection.lastPong = 0;
+	const uint32_t generation = Load(connection.generation) + 1;
+	connection.generation.store(generation, std::memory_order_release);
+
+	mConnectionTable.insert(address, index);
+	// First round-trip measured right away : due before any other, so the queue stays in due order
+	queuePing(index, generation, std::chrono::steady_clock::now(), true);
+}
+void NetService::closeConnection(const Bousk::Network::Address& address)
+{
+	const uint32_t index = findConnection(address);
+	if (index == NoConnection)
+		return;
+	mConnectionTable.erase(address, index);
+
+	// Even : its pending ping is dropped and samplers skip it
+	Connection& connection = mConnections[index];
+	connection.generation.store(Load(connection.generation) + 1, std::memory_order_release);
+	mFreeConnections.push_back(index);
+}
+
+bool NetService::onDatagram(const Bousk::Network::Messages::UserData& userData)
+{
+	const uint32_t index = findConnection(userData.emitter());
+	Connection* connection = index != NoConnection ? &mConnections[index] : nullptr;
+	if (connection)
+	{
+		Add(connection->datagramsIn, 1);
+		Add(connection->bytesIn, userData.data.size());
+	}
+	// Pings and pongs travel alone : only the first message tells whether the datagram is ours
+	TicTacToe::Net::PacketReader reader(userData.data.data(), userData.data.size());
+	TicTacToe::Net::MessageType type;
+	if (!reader.next(type))
+		return false;
+	if (type == TicTacToe::Net::MessageType::Ping)
+	{
+		TicTacToe::Net::Ping ping;
+		if (reader.read(ping))
+		{
+			TicTacToe::Net::Pong pong;
+			pong.stamp = ping.stamp;
+			send(userData.emitter(), pong);
+		}
+		return true;
+	}
+	if (type == TicTacToe::Net::MessageType::Pong)
+	{
+		TicTacToe::Net::Pong pong;
+		if (connection && reader.read(pong))
+			onPong(*connection, pong.stamp);
+		return true;
+	}
+	return false;
+}
+void NetService::onPong(Connection& connection, uint32_t pongStamp)
+{
+	const uint64_t pongs = Load(connection.pongsReceived);
+	if (pongs > 0 && pongStamp == connection.lastPong)
+	{
+		Add(connection.duplicatePongs, 1);
+		return;
+	}
+	connection.lastPong = pongStamp;
+	Add(connection.pongsReceived, 1);
+	// Stamps wrap every 71 minutes, long after any ping got its answer
+	const uint64_t rtt = stamp() - pongStamp;
+	uint64_t smoothedRtt = rtt;
+	uint64_t rttVariation = rtt / 2;
+	if (pongs > 0)
+	{
+		const uint64_t previous = Load(connection.smoothedRtt);
+		const uint64_t delta = previous > rtt ? previous - rtt : rtt - previous;
+		rttVariation = (3 * Load(connection.rttVariation) + delta) / 4;
+		smoothedRtt = (7 * previous + rtt) / 8;
+	}
+	Store(connection.smoothedRtt, smoothedRtt);
+	Store(connection.rttVariation, rttVariation);
+	Add(connection.rtt[std::min(Histogram::BucketOf(rtt), RttBucketsCount - 1)], 1);
+}
+void NetService::countSent(const Bousk::Network::Address& target, size_t size)
+{
+	const uint32_t index = findConnection(target);
+	if (index == NoConnection)
+		return;
+	Connection& connection = mConnections[index];
+	Add(connection.datagramsOut, 1);
+	Add(connection.bytesOut, size);
+	// Ticks are stored plus one : 0 is never
+	if (connection.lastSendTick != mTick + 1)
+	{
+		connection.lastSendTick = mTick + 1;
+		Store(connection.queuedDatagrams, 0);
+	}
+	Add(connection.queuedDatagrams, 1);
+	if (Load(connection.queuedDatagrams) > Load(connection.maxQueuedDatagrams))
+		Store(connection.maxQueuedDatagrams, Load(connection.queuedDatagrams));
+}
+void NetService::sendPings()
+{
+	const auto now = std::chrono::steady_clock::now();
+	while (mPingsCount > 0 && mPendingPings[mPingsFront].due <= now)
+	{
+		const PendingPing ping = mPendingPings[mPingsFront];
+		mPingsFront = (mPingsFront + 1) % mPendingPings.size();
+		--mPingsCount;
+		Connection& connection = mConnections[ping.connection];
+		// Closed since, and maybe reopened with a ping of its own
+		if (Load(connection.generation) != ping.generation)
+			continue;
+		TicTacToe::Net::Ping message;
+		message.stamp = stamp();
+		send(connection.address, message);
+		Add(connection.pingsSent, 1);
+		queuePing(ping.connection, ping.generation, now + PingInterval, false);
+	}
+}
+void NetService::queuePing(uint32_t connection, uint32_t generation, std::chrono::steady_clock::time_point due, bool first)
+{
+	const size_t size = mPendingPings.size();
+	if (mPingsCount == size)
+	{
+		// Full of pings of closed connections, reopened faster than they're due : drop them, keeping the order
+		size_t kept = 0;
+		for (size_t i = 0; i < mPingsCount; ++i)
+		{
+			const PendingPing& ping = mPendingPings[(mPingsFront + i) % size];
+			if (Load(mConnections[ping.connection].generation) == ping.generation)
+				mPendingPings[(mPingsFront + kept++) % size] = ping;
+		}
+		mPingsCount = kept;
+	}
+	if (first)
+		mPingsFront = (mPingsFront + size - 1) % size;
+	mPendingPings[first ? mPingsFront : (mPingsFront + mPingsCount) % size] = { connection, generation, due };
+	++mPingsCount;
+}
+uint32_t NetService::stamp() const
+{
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mEpoch).count());
 }
 
 #undef FORWARD_TO_LISTENERS
\ No newline at end of file
@@ -4,17 +4,37 @@
 #include <Messages.hpp>
 #include <UDP/UDPClient.hpp>
 
-#include <unordered_set>
+#include <AddressTable.hpp>
+#include <Histogram.hpp>
+#include <Net.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 class NetService
 {
 public:
+	// Channels registered by the constructor, in registration order
+	enum class Channel : uint8_t
+	{
+		ReliableOrdered,
+		UnreliableOrdered,
+	};
+	static constexpr Channel ChannelOf(TicTacToe::Net::Delivery delivery)
+	{
+		return delivery == TicTacToe::Net::Delivery::Sequenced ? Channel::UnreliableOrdered : Channel::ReliableOrdered;
+	}
 	struct Parameters
 	{
 		Bousk::Network::Address hostAddress;
 		Bousk::uint16 localPort{ 0 };
 		bool networked{ false };
 		bool host{ false };
+		// Connections measured by the service, the ones beyond connect normally but have no telemetry
+		size_t maxConnections{ 1 };
 	};
 	class IListener
 	{
@@ -30,6 +50,62 @@ public:
 	protected:
 		virtual ~IListener() = default;
 	};
+	struct Statistics
+	{
+		uint64_t dispatchedMessages{ 0 };
+		// Time spent classifying and dispatching messages, listeners included
+		std::chrono::nanoseconds dispatchTime{ 0 };
+
+		double nanosecondsPerMessage() const { return dispatchedMessages ? static_cast<double>(dispatchTime.count()) / dispatchedMessages : 0.; }
+	};
+	// Telemetry of a connection, as seen from this side of it
+	// Round-trip times come from the service own pings, sent every PingInterval on the unreliable channel :
+	// they measure the network alone, and the unanswered ones were lost
+	struct ConnectionSample
+	{
+		Bousk::uint16 port{ 0 };
+		uint64_t datagramsIn{ 0 };
+		uint64_t bytesIn{ 0 };
+		uint64_t datagramsOut{ 0 };
+		uint64_t bytesOut{ 0 };
+		// Datagrams handed to the library by the last flush() sending any to the connection, and the most ever
+		uint32_t queuedDatagrams{ 0 };
+		uint32_t maxQueuedDatagrams{ 0 };
+		uint64_t pingsSent{ 0 };
+		uint64_t pongsReceived{ 0 };
+		// Pongs received again, not counted above
+		uint64_t duplicatePongs{ 0 };
+		// Smoothed as TCP does (RFC 6298)
+		std::chrono::microseconds smoothedRtt{ 0 };
+		std::chrono::microseconds rttVariation{ 0 };
+		// Microseconds, each round-trip counted as the upper bound of its bucket
+		Histogram rtt;
+
+		// Lost or still in flight
+		uint64_t unansweredPings() const { return pingsSent - pongsReceived; }
+	};
+	// Pooled datagram, serialized in place then sent by reference on flush()
+	// A shared one has no target of its own : it's encoded once then queued to any number of targets
+	class SendBuffer
+	{
+		friend class NetService;
+	public:
+		static constexpr size_t Capacity = 256;
+
+		TicTacToe::Net::PacketWriter& writer() { return mWriter; }
+		const Bousk::Network::Address& target() const { return mTarget; }
+		Channel channel() const { return mChannel; }
+
+	private:
+		SendBuffer()
+			: mWriter(mData.data(), mData.size())
+		{}
+
+		std::array<uint8_t, Capacity> mData;
+		TicTacToe::Net::PacketWriter mWriter;
+		Bousk::Network::Address mTarget;
+		Channel mChannel{ Channel::ReliableOrdered };
+	};
 public:
 	NetService();
 	bool init(const Parameters& parameters);
@@ -39,17 +115,133 @@ public:
 	void process();
 	void flush();
 
-	inline void addListener(IListener* listener) { mListeners.insert(listener); }
-	inline void removeListener(IListener* listener) { mListeners.erase(listener); }
+	void addListener(IListener* listener);
+	void removeListener(IListener* listener);
 
 	inline bool isInitialized() const { return mState == State::Initialized; }
 	inline bool isNetworked() const { return mContext.networked; }
 	inline bool isHost() const { return mContext.host; }
 
-	void sendTo(const Bousk::Network::Address& target, const Bousk::uint8* data, const size_t datasize);
+	void sendTo(const Bousk::Network::Address& target, const Bousk::uint8* data, const size_t datasize, Channel channel = Channel::ReliableOrdered);
+	// Empty buffer toward target, queued right away : messages of the channel delivery can be written into it until the next flush()
+	// Buffers come from a pool which only grows to the most buffers queued in a tick, then never allocates again
+	SendBuffer& acquireSendBuffer(const Bousk::Network::Address& target, Channel channel = Channel::ReliableOrdered);
+	// Empty shared buffer, valid until the next flush() like the ones above
+	SendBuffer& acquireSharedBuffer(Channel channel = Channel::ReliableOrdered);
+	// Queue a reference to buffer toward target : broadcasting to N targets encodes the packet once and queues N references
+	void sendTo(const Bousk::Network::Address& target, const SendBuffer& buffer);
+	// Message alone in a datagram toward target, on the channel its delivery calls for
+	template<class Message>
+	bool send(const Bousk::Network::Address& target, const Message& message)
+	{
+		return acquireSendBuffer(target, ChannelOf(Message::DeliveryMode)).writer().write(message);
+	}
+	// Incremented by each flush() : a buffer acquired during a tick stays valid while the tick is the same
+	uint64_t tick() const { return mTick; }
+
+	const Statistics& statistics() const { return mStatistics; }
+	// Telemetry slots are allocated by init() and kept until the next one : sampling them from any thread is safe meanwhile
+	// Counters are relaxed atomics written by the service thread only : samplers never slow it down, nor each other
+	size_t connectionsCapacity() const { return mConnectionsCapacity; }
+	// Copy the telemetry of the connection using given slot, false if there's none
+	bool sampleConnection(size_t index, ConnectionSample& sample) const;
+
+	static constexpr std::chrono::milliseconds PingInterval{ 1000 };
 
 private:
-	std::unordered_set<IListener*> mListeners;
+	// Messages the service forwards, in dispatch table order
+	enum class IncomingType : uint8_t
+	{
+		IncomingConnection,
+		Connection,
+		Disconnection,
+		UserData,
+		Ignored,
+	};
+	struct Incoming
+	{
+		std::unique_ptr<Bousk::Network::Messages::Base> message;
+		IncomingType type;
+	};
+	using Dispatcher = void (*)(NetService&, const Bousk::Network::Messages::Base&);
+	static const std::array<Dispatcher, static_cast<size_t>(IncomingType::Ignored) + 1> Dispatchers;
+	static IncomingType TypeOf(const Bousk::Network::Messages::Base& message);
+	void dispatch(size_t count);
+
+	// Round-trip times up to 16s, longer ones land in the last bucket
+	static constexpr unsigned int RttBucketsCount = Histogram::BucketOf((1u << 24) - 1) + 1;
+	static constexpr uint32_t NoConnection = AddressTable::None;
+	struct Connection
+	{
+		// Odd while a connection uses the slot. Released once the slot is reset : a sampler seeing it unchanged around its reads got consistent values.
+		std::atomic<uint32_t> generation{ 0 };
+		std::atomic<Bousk::uint16> port{ 0 };
+		std::atomic<uint64_t> datagramsIn{ 0 };
+		std::atomic<uint64_t> bytesIn{ 0 };
+		std::atomic<uint64_t> datagramsOut{ 0 };
+		std::atomic<uint64_t> bytesOut{ 0 };
+		std::atomic<uint32_t> queuedDatagrams{ 0 };
+		std::atomic<uint32_t> maxQueuedDatagrams{ 0 };
+		std::atomic<uint64_t> pingsSent{ 0 };
+		std::atomic<uint64_t> pongsReceived{ 0 };
+		std::atomic<uint64_t> duplicatePongs{ 0 };
+		// Microseconds
+		std::atomic<uint32_t> smoothedRtt{ 0 };
+		std::atomic<uint32_t> rttVariation{ 0 };
+		std::array<std::atomic<uint32_t>, RttBucketsCount> rtt{};
+
+		// Service thread only
+		Bousk::Network::Address address;
+		uint64_t lastSendTick{ 0 };
+		uint32_t lastPong{ 0 };
+	};
+	uint32_t findConnection(const Bousk::Network::Address& address) const;
+	void openConnection(const Bousk::Network::Address& address);
+	void closeConnection(const Bousk::Network::Address& address);
+	// Count the datagram, then answer it if it's a ping : true when it was a ping or a pong, which listeners don't see
+	bool onDatagram(const Bousk::Network::Messages::UserData& userData);
+	void onPong(Connection& connection, uint32_t stamp);
+	void countSent(const Bousk::Network::Address& target, size_t size);
+	void sendPings();
+	// Queue the next ping of a connection, at the front when it's due before all the others
+	void queuePing(uint32_t connection, uint32_t generation, std::chrono::steady_clock::time_point due, bool first);
+	uint32_t stamp() const;
+
+	// Contiguous : dispatch walks listeners in cache order
+	std::vector<IListener*> mListeners;
+	// Messages of the current tick, classified once then dispatched through Dispatchers. Preallocated, never grows.
+	static constexpr size_t IncomingCapacity = 1024;
+	std::array<Incoming, IncomingCapacity> mIncoming;
+	Statistics mStatistics;
+
+	std::vector<std::unique_ptr<SendBuffer>> mFreeSendBuffers;
+	std::vector<std::unique_ptr<SendBuffer>> mQueuedSendBuffers;
+	std::vector<std::unique_ptr<SendBuffer>> mSharedSendBuffers;
+	struct SharedSend
+	{
+		Bousk::Network::Address target;
+		const SendBuffer* buffer;
+	};
+	std::vector<SharedSend> mSharedSends;
+	uint64_t mTick{ 0 };
+
+	std::unique_ptr<Connection[]> mConnections;
+	size_t mConnectionsCapacity{ 0 };
+	std::vector<uint32_t> mFreeConnections;
+	AddressTable mConnectionTable;
+	struct PendingPing
+	{
+		uint32_t connection;
+		uint32_t generation;
+		std::chrono::steady_clock::time_point due;
+	};
+	// Each connection has its next ping queued : pushed back PingInterval from now, so the front is always the next one due
+	// Ring of twice the connections capacity, allocated by init : one live ping per connection, and room for those of closed ones
+	std::vector<PendingPing> mPendingPings;
+	size_t mPingsFront{ 0 };
+	size_t mPingsCount{ 0 };
+	// Origin of the ping stamps
+	std::chrono::steady_clock::time_point mEpoch;
 	Bousk::Network::UDP::Client mUdpClient;
 	Parameters mContext;
 	enum class State {
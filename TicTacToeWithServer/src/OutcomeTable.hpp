@@ -0,0 +1,116 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace TicTacToe
+{
+	// Game theoretic value and best move of every 3x3 position, generated at compile time
+	// Indexed by Grid::positionIndex() so a bot move is a single load, without any search or warm up
+	namespace OutcomeTable
+	{
+		// 2 bytes per position, no padding : the table can be dumped to a file and memory mapped as is
+		struct Entry
+		{
+			// From the player to move point of view, same scale as Solver : > 0 is a win, < 0 a loss, 0 a draw
+			// The further from 0, the quicker the game ends
+			int8_t value;
+			// Best move as x * 3 + y, NoMove if the position is over or unreachable
+			uint8_t move;
+		};
+		static_assert(sizeof(Entry) == 2, "Entry must stay packed");
+
+		constexpr uint8_t NoMove = 0xFF;
+		constexpr unsigned int Size = Grid::PositionsCount;
+
+		namespace Details
+		{
+			constexpr unsigned int PopCount(uint16_t bitboard)
+			{
+				unsigned int count = 0;
+				for (; bitboard; bitboard &= bitboard - 1)
+					++count;
+				return count;
+			}
+			constexpr std::array<Entry, Size> Build()
+			{
+				std::array<Entry, Size> table{};
+				// Children have a greater index than their parent : fill the table backward so children are always known
+				for (unsigned int index = Size; index-- > 0;)
+				{
+					Entry& entry = table[index];
+					entry.value = 0;
+					entry.move = NoMove;
+
+					uint16_t x = 0;
+					uint16_t o = 0;
+					for (unsigned int i = 0, digits = index; i < 9; ++i, digits /= 3)
+					{
+						if (digits % 3 == 1)
+							x |= static_cast<uint16_t>(1u << i);
+						else if (digits % 3 == 2)
+							o |= static_cast<uint16_t>(1u << i);
+					}
+					const unsigned int xCount = PopCount(x);
+					const unsigned int oCount = PopCount(o);
+					// X always plays first
+					if (xCount != oCount && xCount != oCount + 1)
+						continue;
+					const bool xToPlay = xCount == oCount;
+					const bool xWon = Bitboard::HasLine(x);
+					const bool oWon = Bitboard::HasLine(o);
+					// A winning line must come from the last move
+					if ((xWon && xToPlay) || (oWon && !xToPlay))
+						continue;
+					const unsigned int emptyCount = 9 - xCount - oCount;
+					if (xWon || oWon)
+					{
+						entry.value = static_cast<int8_t>(-static_cast<int>(emptyCount + 1));
+						continue;
+					}
+					if (emptyCount == 0)
+						continue;
+
+					const unsigned int digit = xToPlay ? 1 : 2;
+					int bestValue = -100;
+					for (unsigned int i = 0; i < 9; ++i)
+					{
+						if ((x | o) & (1u << i))
+							continue;
+						const int value = -table[index + digit * Grid::PositionIndexDigits[i]].value;
+						if (value > bestValue)
+						{
+							bestValue = value;
+							entry.move = static_cast<uint8_t>(i);
+						}
+					}
+					entry.value = static_cast<int8_t>(bestValue);
+				}
+				return table;
+			}
+		}
+
+		// Positions which can't be reached in a game are stored as a draw with NoMove
+		inline constexpr std::array<Entry, Size> Table = Details::Build();
+
+		constexpr const Entry& Lookup(const Grid& grid) { return Table[grid.positionIndex()]; }
+		// Raw access to link or map the table elsewhere
+		inline const void* Data() { return Table.data(); }
+		constexpr size_t DataSize() { return sizeof(Table); }
+
+		static_assert(Table[0].value == 0, "Perfect play from the empty grid is a draw");
+		static_assert([]()
+		{
+			Grid grid;
+			grid.play(0, 0, Case::X);
+			grid.play(1, 0, Case::O);
+			grid.play(1, 1, Case::X);
+			// O must block the diagonal, and loses anyway
+			const Entry& entry = Lookup(grid);
+			return entry.move == 8 && entry.value < 0;
+		}(), "Lookup mismatch");
+	}
+}
\ No newline at end of file
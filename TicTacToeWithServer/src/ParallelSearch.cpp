@@ -0,0 +1,55 @@
+#include <ParallelSearch.hpp>
+
+namespace TicTacToe
+{
+	SharedTranspositionTable::SharedTranspositionTable(unsigned int sizeLog2)
+		: mSlots(std::make_unique<Slot[]>(size_t(1) << sizeLog2))
+		, mMask((size_t(1) << sizeLog2) - 1)
+	{}
+	void SharedTranspositionTable::clear()
+	{
+		for (size_t i = 0; i <= mMask; ++i)
+		{
+			mSlots[i].check.store(0, std::memory_order_relaxed);
+			mSlots[i].data.store(0, std::memory_order_relaxed);
+		}
+	}
+	bool SharedTranspositionTable::probe(uint64_t key, Entry& entry) const
+	{
+		const Slot& slot = mSlots[key & mMask];
+		const uint64_t data = slot.data.load(std::memory_order_relaxed);
+		const uint64_t check = slot.check.load(std::memory_order_relaxed);
+		if ((check ^ data) != key)
+			return false;
+		entry = Unpack(data);
+		return entry.bound != Bound::None;
+	}
+	void SharedTranspositionTable::store(uint64_t key, const Entry& entry)
+	{
+		Slot& slot = mSlots[key & mMask];
+		// Keep a deeper result of the same position
+		const uint64_t previousData = slot.data.load(std::memory_order_relaxed);
+		if ((slot.check.load(std::memory_order_relaxed) ^ previousData) == key && Unpack(previousData).depth > entry.depth)
+			return;
+		const uint64_t data = Pack(entry);
+		slot.check.store(key ^ data, std::memory_order_relaxed);
+		slot.data.store(data, std::memory_order_relaxed);
+	}
+
+	uint64_t SharedTranspositionTable::Pack(const Entry& entry)
+	{
+		return static_cast<uint64_t>(static_cast<uint32_t>(entry.value))
+			| (static_cast<uint64_t>(entry.move) << 32)
+			| (static_cast<uint64_t>(entry.depth) << 48)
+			| (static_cast<uint64_t>(entry.bound) << 56);
+	}
+	SharedTranspositionTable::Entry SharedTranspositionTable::Unpack(uint64_t data)
+	{
+		Entry entry;
+		entry.value = static_cast<int32_t>(static_cast<uint32_t>(data));
+		entry.move = static_cast<uint16_t>(data >> 32);
+		entry.depth = static_cast<uint8_t>(data >> 48);
+		entry.bound = static_cast<Bound>((data >> 56) & 0xFF);
+		return entry;
+	}
+}
\ No newline at end of file
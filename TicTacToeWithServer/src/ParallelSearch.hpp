@@ -0,0 +1,453 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace TicTacToe
+{
+	// Transposition table shared by all search threads without any lock
+	// Each slot stores (key ^ data) beside data : a slot torn by concurrent writes fails the check and is just a miss
+	class SharedTranspositionTable
+	{
+	public:
+		enum class Bound : uint8_t
+		{
+			None,
+			Exact,
+			Lower,
+			Upper,
+		};
+		struct Entry
+		{
+			int32_t value{ 0 };
+			// Case index x * Height + y
+			uint16_t move{ 0 };
+			uint8_t depth{ 0 };
+			Bound bound{ Bound::None };
+		};
+	public:
+		// Table has 2^sizeLog2 slots of 16 bytes
+		explicit SharedTranspositionTable(unsigned int sizeLog2);
+		~SharedTranspositionTable() = default;
+
+		void clear();
+		// Return true and fill entry if key is known, false otherwise
+		bool probe(uint64_t key, Entry& entry) const;
+		void store(uint64_t key, const Entry& entry);
+
+	private:
+		static uint64_t Pack(const Entry& entry);
+		static Entry Unpack(uint64_t data);
+
+	private:
+		struct Slot
+		{
+			std::atomic<uint64_t> check{ 0 };
+			std::atomic<uint64_t> data{ 0 };
+		};
+		std::unique_ptr<Slot[]> mSlots;
+		size_t mMask;
+	};
+
+	// Lazy SMP alpha-beta search for any BasicGrid
+	// Every thread runs its own iterative deepening from the root and they only cooperate through the shared transposition table
+	// Helpers start at different depths and try moves in a different order so they fill the table ahead of the main thread
+	template<class GridType>
+	class ParallelSearch
+	{
+	public:
+		static constexpr unsigned int Width = GridType::Width;
+		static constexpr unsigned int Height = GridType::Height;
+		static constexpr unsigned int CasesCount = Width * Height;
+
+		struct Limits
+		{
+			// Wall clock budget for the whole move
+			std::chrono::milliseconds budget{ 1000 };
+			unsigned int maxDepth{ CasesCount };
+			// Main thread included
+			unsigned int threads{ std::max(1u, std::thread::hardware_concurrency()) };
+		};
+		struct Report
+		{
+			unsigned int x{ 0 };
+			unsigned int y{ 0 };
+			// From player to move point of view
+			int value{ 0 };
+			// Deepest fully searched depth
+			unsigned int depth{ 0 };
+			// Nodes visited by all threads
+			uint64_t nodes{ 0 };
+			std::chrono::microseconds elapsed{ 0 };
+
+			double nodesPerSecond() const { return elapsed.count() > 0 ? nodes * 1000000. / elapsed.count() : 0.; }
+		};
+		using ReportCallback = std::function<void(const Report&)>;
+
+		static constexpr int WinScore = 1 << 24;
+
+	public:
+		explicit ParallelSearch(unsigned int tableSizeLog2 = 22);
+		~ParallelSearch() = default;
+
+		// Search the best move for player within limits. Return false if there is no move to play, true otherwise.
+		// If the budget runs out before depth 1 completes, report holds a legal move at depth 0 : the table one if any, else the first candidate
+		// onDepthCompleted is called from the main search thread each time it completes a depth
+		bool search(const GridType& grid, Case player, const Limits& limits, Report& report, const ReportCallback& onDepthCompleted = nullptr);
+
+		SharedTranspositionTable& table() { return mTable; }
+
+	private:
+		using Moves = std::array<uint16_t, CasesCount>;
+		struct Worker
+		{
+			unsigned int index{ 0 };
+			uint64_t localNodes{ 0 };
+			std::atomic<uint64_t> nodes{ 0 };
+			// Best move of the deepest completed iteration
+			uint16_t bestMove{ 0 };
+			int bestValue{ 0 };
+			unsigned int completedDepth{ 0 };
+		};
+
+		void run(Worker& worker, const GridType& grid, Case player, unsigned int maxDepth, const ReportCallback& onDepthCompleted);
+		// Search root moves at given depth. Return false if search was stopped before completion.
+		bool searchRoot(Worker& worker, GridType& grid, Case player, unsigned int depth, uint16_t& bestMove, int& bestValue);
+		int negamax(Worker& worker, GridType& grid, Case player, unsigned int depth, unsigned int ply, int alpha, int beta);
+		// Fill moves with candidate cases, preferred move first. Return moves count.
+		unsigned int generateMoves(const Worker& worker, const GridType& grid, uint16_t preferredMove, Moves& moves) const;
+		// Static evaluation from player point of view : every line of K cases holding only one player stones is worth 4^stones
+		int evaluate(const GridType& grid, Case player) const;
+
+		bool shouldStop(Worker& worker);
+		uint64_t totalNodes() const;
+		static Case Opponent(Case player) { return player == Case::X ? Case::O : Case::X; }
+
+	private:
+		SharedTranspositionTable mTable;
+		std::vector<std::unique_ptr<Worker>> mWorkers;
+		std::atomic<bool> mStop{ false };
+		std::chrono::steady_clock::time_point mStart;
+		std::chrono::steady_clock::time_point mDeadline;
+	};
+
+	template<class GridType>
+	ParallelSearch<GridType>::ParallelSearch(unsigned int tableSizeLog2)
+		: mTable(tableSizeLog2)
+	{}
+
+	template<class GridType>
+	bool ParallelSearch<GridType>::search(const GridType& grid, Case player, const Limits& limits, Report& report, const ReportCallback& onDepthCompleted)
+	{
+		if (grid.isFinished() || player == Case::Empty)
+			return false;
+
+		mStop = false;
+		mStart = std::chrono::steady_clock::now();
+		mDeadline = mStart + limits.budget;
+		const unsigned int maxDepth = std::min(std::max(limits.maxDepth, 1u), CasesCount);
+		mWorkers.clear();
+		for (unsigned int i = 0; i < std::max(limits.threads, 1u); ++i)
+		{
+			mWorkers.push_back(std::make_unique<Worker>());
+			mWorkers.back()->index = i;
+		}
+
+		std::vector<std::thread> helpers;
+		for (size_t i = 1; i < mWorkers.size(); ++i)
+		{
+			Worker& helper = *mWorkers[i];
+			helpers.emplace_back([this, &helper, &grid, player, maxDepth]() { run(helper, grid, player, maxDepth, nullptr); });
+		}
+		run(*mWorkers[0], grid, player, maxDepth, onDepthCompleted);
+		// Main thread is done : its result is final
+		mStop = true;
+		for (std::thread& helper : helpers)
+			helper.join();
+
+		// Helpers may have completed a deeper iteration than main thread
+		const Worker* best = mWorkers[0].get();
+		for (const auto& worker : mWorkers)
+		{
+			if (worker->completedDepth > best->completedDepth)
+				best = worker.get();
+		}
+		uint16_t bestMove = best->bestMove;
+		int bestValue = best->bestValue;
+		if (best->completedDepth == 0)
+		{
+			// Out of time before any iteration completed : still play a legal move
+			SharedTranspositionTable::Entry entry;
+			const uint16_t preferredMove = mTable.probe(grid.hash(), entry) ? entry.move : static_cast<uint16_t>(CasesCount);
+			Moves moves;
+			if (generateMoves(*mWorkers[0], grid, preferredMove, moves) == 0)
+				return false;
+			bestMove = moves[0];
+			bestValue = 0;
+		}
+		report.x = bestMove / Height;
+		report.y = bestMove % Height;
+		report.value = bestValue;
+		report.depth = best->completedDepth;
+		report.nodes = totalNodes();
+		report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart);
+		return true;
+	}
+
+	template<class GridType>
+	void ParallelSearch<GridType>::run(Worker& worker, const GridType& grid, Case player, unsigned int maxDepth, const ReportCallback& onDepthCompleted)
+	{
+		// Each thread plays and takes back moves on its own copy of the grid
+		GridType board = grid;
+		// Half the helpers start one ply deeper
+		const unsigned int startDepth = std::min(1 + (worker.index & 1), maxDepth);
+		for (unsigned int depth = startDepth; depth <= maxDepth && !mStop; ++depth)
+		{
+			uint16_t bestMove = 0;
+			int bestValue = 0;
+			if (!searchRoot(worker, board, player, depth, bestMove, bestValue))
+				break;
+			worker.bestMove = bestMove;
+			worker.bestValue = bestValue;
+			worker.completedDepth = depth;
+			if (onDepthCompleted)
+			{
+				Report report;
+				report.x = bestMove / Height;
+				report.y = bestMove % Height;
+				report.value = bestValue;
+				report.depth = depth;
+				report.nodes = totalNodes();
+				report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart);
+				onDepthCompleted(report);
+			}
+			// A forced result won't change with deeper searches
+			if (std::abs(bestValue) > WinScore - static_cast<int>(CasesCount))
+				break;
+		}
+		worker.nodes.store(worker.localNodes, std::memory_order_relaxed);
+	}
+
+	template<class GridType>
+	bool ParallelSearch<GridType>::searchRoot(Worker& worker, GridType& grid, Case player, unsigned int depth, uint16_t& bestMove, int& bestValue)
+	{
+		const uint64_t key = grid.hash();
+		SharedTranspositionTable::Entry entry;
+		const uint16_t preferredMove = mTable.probe(key, entry) ? entry.move : worker.bestMove;
+		Moves moves;
+		const unsigned int movesCount = generateMoves(worker, grid, preferredMove, moves);
+
+		int alpha = -WinScore - 1;
+		const int beta = WinScore + 1;
+		bestValue = alpha;
+		for (unsigned int i = 0; i < movesCount; ++i)
+		{
+			const uint16_t move = moves[i];
+			grid.play(move / Height, move % Height, player);
+			int value;
+			if (grid.winner() == player)
+				value = WinScore - 1;
+			else if (grid.isFinished())
+				value = 0;
+			else
+				value = -negamax(worker, grid, Opponent(player), depth - 1, 1, -beta, -alpha);
+			grid.unplay();
+			if (mStop)
+				return false;
+			if (value > bestValue)
+			{
+				bestValue = value;
+				bestMove = move;
+			}
+			alpha = std::max(alpha, value);
+		}
+		if (std::abs(bestValue) < WinScore - static_cast<int>(CasesCount))
+			mTable.store(key, { bestValue, bestMove, static_cast<uint8_t>(std::min(depth, 255u)), SharedTranspositionTable::Bound::Exact });
+		return movesCount > 0;
+	}
+
+	template<class GridType>
+	int ParallelSearch<GridType>::negamax(Worker& worker, GridType& grid, Case player, unsigned int depth, unsigned int ply, int alpha, int beta)
+	{
+		if (shouldStop(worker))
+			return 0;
+		if (depth == 0)
+			return evaluate(grid, player);
+
+		const uint64_t key = grid.hash();
+		SharedTranspositionTable::Entry entry;
+		uint16_t preferredMove = CasesCount;
+		if (mTable.probe(key, entry))
+		{
+			preferredMove = entry.move;
+			if (entry.depth >= depth)
+			{
+				switch (entry.bound)
+				{
+					case SharedTranspositionTable::Bound::Exact: return entry.value;
+					case SharedTranspositionTable::Bound::Lower: alpha = std::max(alpha, entry.value); break;
+					case SharedTranspositionTable::Bound::Upper: beta = std::min(beta, entry.value); break;
+					case SharedTranspositionTable::Bound::None: break;
+				}
+				if (alpha >= beta)
+					return entry.value;
+			}
+		}
+
+		Moves moves;
+		const unsigned int movesCount = generateMoves(worker, grid, preferredMove, moves);
+		if (movesCount == 0)
+			return evaluate(grid, player);
+		const int originalAlpha = alpha;
+		int bestValue = -WinScore - 1;
+		uint16_t bestMove = moves[0];
+		for (unsigned int i = 0; i < movesCount; ++i)
+		{
+			const uint16_t move = moves[i];
+			grid.play(move / Height, move % Height, player);
+			int value;
+			if (grid.winner() == player)
+				value = WinScore - static_cast<int>(ply) - 1;
+			else if (grid.isFinished())
+				value = 0;
+			else
+				value = -negamax(worker, grid, Opponent(player), depth - 1, ply + 1, -beta, -alpha);
+			grid.unplay();
+			if (mStop)
+				return 0;
+			if (value > bestValue)
+			{
+				bestValue = value;
+				bestMove = move;
+			}
+			alpha = std::max(alpha, value);
+			if (alpha >= beta)
+				break;
+		}
+
+		SharedTranspositionTable::Bound bound = SharedTranspositionTable::Bound::Exact;
+		if (bestValue <= originalAlpha)
+			bound = SharedTranspositionTable::Bound::Upper;
+		else if (bestValue >= beta)
+			bound = SharedTranspositionTable::Bound::Lower;
+		// Win scores depend on the ply they're found at : only store bounds safe to reuse anywhere
+		if (std::abs(bestValue) < WinScore - static_cast<int>(CasesCount))
+			mTable.store(key, { bestValue, bestMove, static_cast<uint8_t>(std::min(depth, 255u)), bound });
+		return bestValue;
+	}
+
+	template<class GridType>
+	unsigned int ParallelSearch<GridType>::generateMoves(const Worker& worker, const GridType& grid, uint16_t preferredMove, Moves& moves) const
+	{
+		// On large grids only cases close to existing stones are worth playing
+		constexpr int Radius = CasesCount > 25 ? 2 : static_cast<int>(std::max(Width, Height));
+		const auto& cases = grid.grid();
+		unsigned int count = 0;
+		bool hasStone = false;
+		std::array<bool, CasesCount> candidates{};
+		for (unsigned int x = 0; x < Width; ++x)
+		{
+			for (unsigned int y = 0; y < Height; ++y)
+			{
+				if (cases[x][y] == Case::Empty)
+					continue;
+				hasStone = true;
+				for (int cx = std::max(0, static_cast<int>(x) - Radius); cx <= std::min(static_cast<int>(Width) - 1, static_cast<int>(x) + Radius); ++cx)
+				{
+					for (int cy = std::max(0, static_cast<int>(y) - Radius); cy <= std::min(static_cast<int>(Height) - 1, static_cast<int>(y) + Radius); ++cy)
+					{
+						if (cases[cx][cy] == Case::Empty)
+							candidates[cx * Height + cy] = true;
+					}
+				}
+			}
+		}
+		if (!hasStone)
+		{
+			moves[0] = static_cast<uint16_t>((Width / 2) * Height + Height / 2);
+			return 1;
+		}
+
+		if (preferredMove < CasesCount && candidates[preferredMove])
+		{
+			moves[count++] = preferredMove;
+			candidates[preferredMove] = false;
+		}
+		// Each helper scans cases from a different start so threads diverge
+		const unsigned int offset = (worker.index * 7) % CasesCount;
+		for (unsigned int i = 0; i < CasesCount; ++i)
+		{
+			const unsigned int index = (i + offset) % CasesCount;
+			if (candidates[index])
+				moves[count++] = static_cast<uint16_t>(index);
+		}
+		return count;
+	}
+
+	template<class GridType>
+	int ParallelSearch<GridType>::evaluate(const GridType& grid, Case player) const
+	{
+		constexpr int K = static_cast<int>(GridType::LineLength);
+		constexpr int Directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+		const auto& cases = grid.grid();
+		int score = 0;
+		for (const auto& direction : Directions)
+		{
+			for (int x = 0; x < static_cast<int>(Width); ++x)
+			{
+				for (int y = 0; y < static_cast<int>(Height); ++y)
+				{
+					const int endX = x + direction[0] * (K - 1);
+					const int endY = y + direction[1] * (K - 1);
+					if (endX >= static_cast<int>(Width) || endY < 0 || endY >= static_cast<int>(Height))
+						continue;
+					int own = 0;
+					int opponent = 0;
+					for (int i = 0; i < K; ++i)
+					{
+						const Case c = cases[x + direction[0] * i][y + direction[1] * i];
+						own += c == player;
+						opponent += c != player && c != Case::Empty;
+					}
+					if (own > 0 && opponent == 0)
+						score += 1 << (2 * own);
+					else if (opponent > 0 && own == 0)
+						score -= 1 << (2 * opponent);
+				}
+			}
+		}
+		return std::clamp(score, -WinScore / 2, WinScore / 2);
+	}
+
+	template<class GridType>
+	bool ParallelSearch<GridType>::shouldStop(Worker& worker)
+	{
+		// Checking the clock is way more expensive than a node : only do it from time to time
+		if ((++worker.localNodes & 1023) == 0)
+		{
+			worker.nodes.store(worker.localNodes, std::memory_order_relaxed);
+			if (std::chrono::steady_clock::now() >= mDeadline)
+				mStop = true;
+		}
+		return mStop.load(std::memory_order_relaxed);
+	}
+
+	template<class GridType>
+	uint64_t ParallelSearch<GridType>::totalNodes() const
+	{
+		uint64_t nodes = 0;
+		for (const auto& worker : mWorkers)
+			nodes += worker->nodes.load(std::memory_order_relaxed);
+		return nodes;
+	}
+}
\ No newline at end of file
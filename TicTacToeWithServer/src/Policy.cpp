@@ -0,0 +1,138 @@
+#include <Policy.hpp>
+
+#include <MonteCarloTreeSearch.hpp>
+#include <OutcomeTable.hpp>
+
+#include <array>
+
+namespace TicTacToe
+{
+	namespace
+	{
+		// For each free cases bitboard : how many free cases, and the index of the nth one
+		// Avoids data dependent loops and their mispredictions in the random playouts hot path
+		struct FreeCases
+		{
+			uint8_t count{ 0 };
+			std::array<uint8_t, 9> indexes{};
+		};
+		constexpr std::array<FreeCases, 512> BuildFreeCasesTable()
+		{
+			std::array<FreeCases, 512> table{};
+			for (unsigned int free = 0; free < 512; ++free)
+			{
+				for (unsigned int index = 0; index < 9; ++index)
+				{
+					if (free & (1u << index))
+						table[free].indexes[table[free].count++] = static_cast<uint8_t>(index);
+				}
+			}
+			return table;
+		}
+		constexpr std::array<FreeCases, 512> FreeCasesTable = BuildFreeCasesTable();
+
+		class RandomPolicy : public IPolicy
+		{
+		public:
+			explicit RandomPolicy(uint64_t seed) : mState(seed | 1) {}
+
+			bool chooseMove(const Grid& grid, Case, unsigned int& x, unsigned int& y) override
+			{
+				const FreeCases& freeCases = FreeCasesTable[grid.bitboard(Case::Empty)];
+				if (grid.isFinished() || freeCases.count == 0)
+					return false;
+				const unsigned int index = freeCases.indexes[next(freeCases.count)];
+				x = index / 3;
+				y = index % 3;
+				return true;
+			}
+
+		private:
+			// xorshift64
+			unsigned int next(unsigned int bound)
+			{
+				mState ^= mState << 13;
+				mState ^= mState >> 7;
+				mState ^= mState << 17;
+				return static_cast<unsigned int>((mState >> 32) * bound >> 32);
+			}
+
+		private:
+			uint64_t mState;
+		};
+
+		class SolverPolicy : public IPolicy
+		{
+		public:
+			bool chooseMove(const Grid& grid, Case, unsigned int& x, unsigned int& y) override
+			{
+				const OutcomeTable::Entry& entry = OutcomeTable::Lookup(grid);
+				if (entry.move == OutcomeTable::NoMove)
+					return false;
+				x = entry.move / 3;
+				y = entry.move % 3;
+				return true;
+			}
+		};
+
+		class MctsPolicy : public IPolicy
+		{
+		public:
+			MctsPolicy()
+				// A 3x3 tree is tiny : the pool is sized for the playouts budget
+				: mSearch(1 << 12)
+			{
+				mLimits.budget = std::chrono::milliseconds(1000);
+				mLimits.maxPlayouts = 256;
+				mLimits.threads = 1;
+			}
+
+			bool chooseMove(const Grid& grid, Case player, unsigned int& x, unsigned int& y) override
+			{
+				MonteCarloTreeSearch<Grid>::Report report;
+				if (!mSearch.search(grid, player, mLimits, report))
+					return false;
+				x = report.x;
+				y = report.y;
+				return true;
+			}
+
+		private:
+			MonteCarloTreeSearch<Grid> mSearch;
+			MonteCarloTreeSearch<Grid>::Limits mLimits;
+		};
+	}
+
+	std::unique_ptr<IPolicy> CreatePolicy(PolicyType type, uint64_t seed)
+	{
+		switch (type)
+		{
+			case PolicyType::Random: return std::make_unique<RandomPolicy>(seed);
+			case PolicyType::Solver: return std::make_unique<SolverPolicy>();
+			case PolicyType::MCTS: return std::make_unique<MctsPolicy>();
+		}
+		return nullptr;
+	}
+	bool ParsePolicyType(const std::string& name, PolicyType& type)
+	{
+		for (PolicyType candidate : { PolicyType::Random, PolicyType::Solver, PolicyType::MCTS })
+		{
+			if (name == PolicyTypeName(candidate))
+			{
+				type = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+	const char* PolicyTypeName(PolicyType type)
+	{
+		switch (type)
+		{
+			case PolicyType::Random: return "random";
+			case PolicyType::Solver: return "solver";
+			case PolicyType::MCTS: return "mcts";
+		}
+		return "unknown";
+	}
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace TicTacToe
+{
+	// Chooses the moves of a bot
+	// Not thread safe : use one instance per thread
+	class IPolicy
+	{
+	public:
+		virtual ~IPolicy() = default;
+		// Fill x & y with the move player should play. Return false if there is none, true otherwise.
+		virtual bool chooseMove(const Grid& grid, Case player, unsigned int& x, unsigned int& y) = 0;
+	};
+
+	enum class PolicyType
+	{
+		// Any free case
+		Random,
+		// Perfect play from OutcomeTable
+		Solver,
+		// Short MonteCarloTreeSearch
+		MCTS,
+	};
+	std::unique_ptr<IPolicy> CreatePolicy(PolicyType type, uint64_t seed);
+	// Return true and fill type if name is a known policy, false otherwise
+	bool ParsePolicyType(const std::string& name, PolicyType& type);
+	const char* PolicyTypeName(PolicyType type);
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include <Solver.hpp>
+
+#include <algorithm>
+
+namespace TicTacToe
+{
+	namespace
+	{
+		constexpr unsigned int Symmetries = 8;
+		// Case (x, y) is moved to the returned case index by given symmetry
+		constexpr unsigned int Transform(unsigned int symmetry, unsigned int x, unsigned int y)
+		{
+			switch (symmetry)
+			{
+				case 0: return x * 3 + y;
+				case 1: return y * 3 + (2 - x);
+				case 2: return (2 - x) * 3 + (2 - y);
+				case 3: return (2 - y) * 3 + x;
+				case 4: return (2 - x) * 3 + y;
+				case 5: return x * 3 + (2 - y);
+				case 6: return y * 3 + x;
+				default: return (2 - y) * 3 + (2 - x);
+			}
+		}
+		// Every 9 bits bitboard transformed by each symmetry
+		constexpr std::array<std::array<uint16_t, 512>, Symmetries> BuildSymmetryTables()
+		{
+			std::array<std::array<uint16_t, 512>, Symmetries> tables{};
+			for (unsigned int symmetry = 0; symmetry < Symmetries; ++symmetry)
+			{
+				for (unsigned int bitboard = 0; bitboard < 512; ++bitboard)
+				{
+					uint16_t transformed = 0;
+					for (unsigned int x = 0; x < 3; ++x)
+					{
+						for (unsigned int y = 0; y < 3; ++y)
+						{
+							if (bitboard & Bitboard::Bit(x, y))
+								transformed |= static_cast<uint16_t>(1u << Transform(symmetry, x, y));
+						}
+					}
+					tables[symmetry][bitboard] = transformed;
+				}
+			}
+			return tables;
+		}
+		constexpr std::array<std::array<uint16_t, 512>, Symmetries> SymmetryTables = BuildSymmetryTables();
+
+		// Center first, then corners, then edges : best moves come first most of the time which maximizes cuts
+		constexpr std::array<unsigned int, 9> MoveOrder{ 4, 0, 2, 6, 8, 1, 3, 5, 7 };
+
+		constexpr int Infinity = 100;
+
+		unsigned int EmptyCount(uint16_t own, uint16_t opponent)
+		{
+			unsigned int count = 0;
+			for (uint16_t free = static_cast<uint16_t>(~(own | opponent) & Bitboard::FullMask); free; free &= free - 1)
+				++count;
+			return count;
+		}
+	}
+
+	Solver::Solver()
+	{
+		clear();
+	}
+	void Solver::clear()
+	{
+		mTable.assign(size_t(1) << KeyBits, Entry{});
+	}
+	void Solver::warmUp()
+	{
+		negamax(0, 0, -Infinity, Infinity);
+	}
+	bool Solver::bestMove(const Grid& grid, Case player, Result& result)
+	{
+		if (grid.isFinished() || player == Case::Empty)
+			return false;
+		const uint16_t own = grid.bitboard(player);
+		const uint16_t opponent = grid.bitboard(player == Case::X ? Case::O : Case::X);
+		const uint16_t free = grid.bitboard(Case::Empty);
+		int bestValue = -Infinity;
+		for (unsigned int index : MoveOrder)
+		{
+			const uint16_t bit = static_cast<uint16_t>(1u << index);
+			if (!(free & bit))
+				continue;
+			// Full window on each child so every root child ends up exact in the table
+			const int value = -negamax(opponent, own | bit, -Infinity, Infinity);
+			if (value > bestValue)
+			{
+				bestValue = value;
+				result.x = index / 3;
+				result.y = index % 3;
+				result.value = value;
+			}
+		}
+		return bestValue != -Infinity;
+	}
+	int Solver::evaluate(const Grid& grid, Case player)
+	{
+		const uint16_t own = grid.bitboard(player);
+		const uint16_t opponent = grid.bitboard(player == Case::X ? Case::O : Case::X);
+		return negamax(own, opponent, -Infinity, Infinity);
+	}
+
+	int Solver::negamax(uint16_t own, uint16_t opponent, int alpha, int beta)
+	{
+		// Opponent just played : did he win ?
+		if (Bitboard::HasLine(opponent))
+			return -static_cast<int>(EmptyCount(own, opponent) + 1);
+		const uint16_t free = static_cast<uint16_t>(~(own | opponent) & Bitboard::FullMask);
+		if (!free)
+			return 0;
+
+		Entry& entry = mTable[CanonicalKey(own, opponent)];
+		switch (entry.bound)
+		{
+			case Bound::Exact: return entry.value;
+			case Bound::Lower: alpha = std::max(alpha, static_cast<int>(entry.value)); break;
+			case Bound::Upper: beta = std::min(beta, static_cast<int>(entry.value)); break;
+			case Bound::None: break;
+		}
+		if (alpha >= beta)
+			return entry.value;
+
+		const int originalAlpha = alpha;
+		int bestValue = -Infinity;
+		for (unsigned int index : MoveOrder)
+		{
+			const uint16_t bit = static_cast<uint16_t>(1u << index);
+			if (!(free & bit))
+				continue;
+			const int value = -negamax(opponent, own | bit, -beta, -alpha);
+			bestValue = std::max(bestValue, value);
+			alpha = std::max(alpha, value);
+			if (alpha >= beta)
+				break;
+		}
+
+		entry.value = static_cast<int8_t>(bestValue);
+		if (bestValue <= originalAlpha)
+			entry.bound = Bound::Upper;
+		else if (bestValue >= beta)
+			entry.bound = Bound::Lower;
+		else
+			entry.bound = Bound::Exact;
+		return bestValue;
+	}
+
+	uint32_t Solver::CanonicalKey(uint16_t own, uint16_t opponent)
+	{
+		uint32_t key = UINT32_MAX;
+		for (const auto& table : SymmetryTables)
+		{
+			const uint32_t transformed = table[own] | (static_cast<uint32_t>(table[opponent]) << 9);
+			key = std::min(key, transformed);
+		}
+		return key;
+	}
+}
\ No newline at end of file
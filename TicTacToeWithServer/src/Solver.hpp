@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Game.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace TicTacToe
+{
+	// Perfect play for the 3x3 Grid
+	// Negamax with alpha-beta pruning and a transposition table indexed by the position canonicalized under the 8 symmetries of the square
+	// The table is filled lazily : once warmed up, any request is a handful of lookups
+	// Not thread safe : use one Solver per thread
+	class Solver
+	{
+	public:
+		struct Result
+		{
+			unsigned int x{ 0 };
+			unsigned int y{ 0 };
+			// From the player to move point of view : > 0 is a win, < 0 a loss, 0 a draw
+			// The further from 0, the quicker the game ends
+			int value{ 0 };
+		};
+	public:
+		Solver();
+		~Solver() = default;
+
+		// Solve the whole game from the empty grid so later requests never search
+		void warmUp();
+		// Find the best move for player in grid. Return false if there is none (game over), true otherwise.
+		bool bestMove(const Grid& grid, Case player, Result& result);
+		// Value of grid for player to move
+		int evaluate(const Grid& grid, Case player);
+		// Forget every known position
+		void clear();
+
+	private:
+		// Score of the position for the player owning own bitboard, who is to move
+		int negamax(uint16_t own, uint16_t opponent, int alpha, int beta);
+
+		// 9 bits for player to move, 9 bits for his opponent
+		static constexpr unsigned int KeyBits = 18;
+		static uint32_t CanonicalKey(uint16_t own, uint16_t opponent);
+
+	private:
+		enum class Bound : uint8_t
+		{
+			None,
+			Exact,
+			Lower,
+			Upper,
+		};
+		struct Entry
+		{
+			int8_t value{ 0 };
+			Bound bound{ Bound::None };
+		};
+		std::vector<Entry> mTable;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <WorkStealingPool.hpp>
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned int threadsCount)
+{
+	threadsCount = std::max(threadsCount, 1u);
+	for (unsigned int i = 0; i < threadsCount; ++i)
+		mQueues.push_back(std::make_unique<Queue>());
+	for (unsigned int i = 0; i < threadsCount; ++i)
+		mThreads.emplace_back(&WorkStealingPool::run, this, i);
+}
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mWorkAvailable.notify_all();
+	for (std::thread& thread : mThreads)
+		thread.join();
+}
+
+void WorkStealingPool::push(Task&& task)
+{
+	Queue& queue = *mQueues[mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size()];
+	++mPending;
+	{
+		// Count it first so a worker taking it right away never sees a negative count
+		std::lock_guard<std::mutex> lock(mMutex);
+		++mQueued;
+	}
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	mWorkAvailable.notify_one();
+}
+void WorkStealingPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mAllDone.wait(lock, [this]() { return mPending == 0; });
+}
+
+void WorkStealingPool::run(unsigned int index)
+{
+	Task task;
+	while (true)
+	{
+		if (take(index, task))
+		{
+			task(index);
+			task = nullptr;
+			if (--mPending == 0)
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mAllDone.notify_all();
+			}
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mMutex);
+		mWorkAvailable.wait(lock, [this]() { return mStop || mQueued > 0; });
+		if (mStop)
+			return;
+	}
+}
+bool WorkStealingPool::take(unsigned int index, Task& task)
+{
+	{
+		Queue& own = *mQueues[index];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty())
+		{
+			task = std::move(own.tasks.front());
+			own.tasks.pop_front();
+			--mQueued;
+			return true;
+		}
+	}
+	for (size_t i = 1; i < mQueues.size(); ++i)
+	{
+		Queue& victim = *mQueues[(index + i) % mQueues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.back());
+			victim.tasks.pop_back();
+			--mQueued;
+			return true;
+		}
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool where each worker owns a task queue
+// A worker takes its own tasks from the front and, once its queue is empty, steals from the back of the others
+class WorkStealingPool
+{
+public:
+	// Receives the index of the worker running it
+	using Task = std::function<void(unsigned int)>;
+public:
+	explicit WorkStealingPool(unsigned int threadsCount);
+	~WorkStealingPool();
+
+	unsigned int size() const { return static_cast<unsigned int>(mThreads.size()); }
+	// Queue task on worker queues in turn
+	void push(Task&& task);
+	// Block until every pushed task is done
+	void wait();
+
+private:
+	void run(unsigned int index);
+	// Take a task from own queue or steal one. Return false if every queue is empty.
+	bool take(unsigned int index, Task& task);
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+	std::vector<std::unique_ptr<Queue>> mQueues;
+	std::vector<std::thread> mThreads;
+	std::atomic<unsigned int> mNextQueue{ 0 };
+	// Tasks pushed but not finished, and tasks pushed but not taken yet
+	std::atomic<size_t> mPending{ 0 };
+	std::atomic<size_t> mQueued{ 0 };
+	std::atomic<bool> mStop{ false };
+	std::mutex mMutex;
+	std::condition_variable mWorkAvailable;
+	std::condition_variable mAllDone;
+};
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include <string>
 
 extern int main_p2p(bool isHost);
-extern int main_merged(bool isNetworked, bool isHost);
+extern int main_merged(bool isNetworked, bool isHost, bool isServerClient);
 extern int main_solo();
 
 enum class MainType
@@ -12,6 +12,7 @@ enum class MainType
     Solo,
     P2P_Host,
     P2P_Client,
+    Server_Client,
 };
 int SDL_main(int argc, char* argv[])
 {
@@ -34,8 +35,13 @@ int SDL_main(int argc, char* argv[])
             type = MainType::P2P_Client;
             break;
         }
+        else if (arg == "-client")
+        {
+            type = MainType::Server_Client;
+            break;
+        }
     }
-    return main_merged(type != MainType::Unknown && type != MainType::Solo, type == MainType::P2P_Host);
+    return main_merged(type != MainType::Unknown && type != MainType::Solo, type == MainType::P2P_Host, type == MainType::Server_Client);
     //switch (type)
     //{
     //    case MainType::Solo: return main_solo();
@@ -5,6 +5,8 @@
 
 #include <SDL.h>
 
+#include <array>
+
 #define CASE_W (200)
 #define CASE_H (200)
 #define WIN_W (3*CASE_W)
@@ -20,4 +22,57 @@ inline SDL_Texture* LoadTexture(const char* filepath, SDL_Renderer* renderer)
         return texture;
     }
     return nullptr;
+}
+
+// Draw every case then the grid lines
+inline void RenderGame(SDL_Renderer* renderer, const std::array<SDL_Texture*, 3>& plays, const TicTacToe::Grid& game)
+{
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(renderer);
+    // Draw cases
+    for (int x = 0; x < 3; ++x)
+    {
+        for (int y = 0; y < 3; ++y)
+        {
+            const TicTacToe::Case caseStatus = game.grid()[x][y];
+            const SDL_Rect position{ x * CASE_W, y * CASE_H, CASE_W, CASE_H };
+            SDL_RenderCopy(renderer, plays[static_cast<unsigned int>(caseStatus)], NULL, &position);
+        }
+    }
+    // Draw grid lines
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    // Horizontal
+    SDL_RenderDrawLine(renderer, 0, CASE_H, WIN_W, CASE_H);
+    SDL_RenderDrawLine(renderer, 0, CASE_H * 2, WIN_W, CASE_H * 2);
+    // Vertical
+    SDL_RenderDrawLine(renderer, CASE_W, 0, CASE_W, WIN_H);
+    SDL_RenderDrawLine(renderer, CASE_W * 2, 0, CASE_W * 2, WIN_H);
+    SDL_RenderPresent(renderer);
+}
+
+// Network protocols need regular updates to acknowledge and resend : networked loops wake up at least this often
+static constexpr int NetworkTickMs = 5;
+
+// Block until an SDL event arrives, or timeoutMs elapses if not negative, then handle every pending event
+// Return false once the window is closed
+template<class EventHandler>
+inline bool HandleEvents(int timeoutMs, EventHandler&& handleEvent)
+{
+    SDL_Event e;
+    const int hasEvent = timeoutMs < 0 ? SDL_WaitEvent(&e) : SDL_WaitEventTimeout(&e, timeoutMs);
+    if (!hasEvent)
+        return true;
+    do
+    {
+        if (e.type == SDL_QUIT)
+            return false;
+        handleEvent(e);
+    } while (SDL_PollEvent(&e));
+    return true;
+}
+// Window content may be lost : redraw
+inline bool NeedsRedraw(const SDL_Event& e)
+{
+    return e.type == SDL_WINDOWEVENT
+        && (e.window.event == SDL_WINDOWEVENT_EXPOSED || e.window.event == SDL_WINDOWEVENT_RESTORED || e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED);
 }
\ No newline at end of file
@@ -2,53 +2,57 @@
 
 #include <Errors.hpp>
 #include <Messages.hpp>
-#include <Serialization/Deserializer.hpp>
-#include <Serialization/Serializer.hpp>
 
+#include <ClientMatch.hpp>
 #include <NetService.hpp>
 
 #include <iostream>
+#include <utility>
 
 static constexpr Bousk::uint16 HostPort = 8888;
 
+// Forward NetService events to the given callables
+// Callables types are kept : no std::function indirection nor allocation
+template<class OnIncomingConnection, class OnConnectionResult, class OnDisconnection, class OnDataReceived>
 class NetListener : public NetService::IListener
 {
-    using OnIncomingConnectionCallback = std::function<bool(const Bousk::Network::Messages::IncomingConnection&)>;
-    using OnConnectionCallback = std::function<void(const Bousk::Network::Messages::Connection&)>;
-    using OnDisconnectionCallback = std::function<void(const Bousk::Network::Messages::Disconnection&)>;
-    using OnDataReceivedCallback = std::function<void(const Bousk::Network::Messages::UserData&)>;
 public:
-    OnIncomingConnectionCallback mOnIncomingConnection;
-    OnConnectionCallback mOnConnectionResult;
-    OnDisconnectionCallback mOnDisconnection;
-    OnDataReceivedCallback mOnDataReceived;
+    NetListener(OnIncomingConnection onIncomingConnection, OnConnectionResult onConnectionResult, OnDisconnection onDisconnection, OnDataReceived onDataReceived)
+        : mOnIncomingConnection(std::move(onIncomingConnection))
+        , mOnConnectionResult(std::move(onConnectionResult))
+        , mOnDisconnection(std::move(onDisconnection))
+        , mOnDataReceived(std::move(onDataReceived))
+    {}
 
 private:
     bool onIncomingConnection(const Bousk::Network::Messages::IncomingConnection& incomingConnection) override
     {
-        return !mOnIncomingConnection || mOnIncomingConnection(incomingConnection);
+        return mOnIncomingConnection(incomingConnection);
     }
 
     void onConnectionResult(const Bousk::Network::Messages::Connection& connection) override
     {
-        if (mOnConnectionResult)
-            mOnConnectionResult(connection);
+        mOnConnectionResult(connection);
     }
 
     void onDisconnection(const Bousk::Network::Messages::Disconnection& disconnection) override
     {
-        if (mOnDisconnection)
-            mOnDisconnection(disconnection);
+        mOnDisconnection(disconnection);
     }
 
     void onDataReceived(const Bousk::Network::Messages::UserData& userdata) override
     {
-        if (mOnDataReceived)
-            mOnDataReceived(userdata);
+        mOnDataReceived(userdata);
     }
+
+private:
+    OnIncomingConnection mOnIncomingConnection;
+    OnConnectionResult mOnConnectionResult;
+    OnDisconnection mOnDisconnection;
+    OnDataReceived mOnDataReceived;
 };
 
-int main_merged(const bool isNetworked, const bool isHost = false)
+int main_merged(const bool isNetworked, const bool isHost = false, const bool isServerClient = false)
 {
     // Use a heap allocation to prevent stack size warning since NetService is quite big
     std::unique_ptr<NetService> netService = std::make_unique<NetService>();
@@ -78,6 +82,8 @@ int main_merged(const bool isNetworked, const bool isHost = false)
         {
             if (netService->isHost())
                 title += "Host";
+            else if (isServerClient)
+                title += "Server";
             else
                 title += "Client";
         }
@@ -117,18 +123,22 @@ int main_merged(const bool isNetworked, const bool isHost = false)
     // Load textures to display : None, X & O
     std::array<SDL_Texture*, 3> plays{ LoadTexture("Empty.bmp", renderer), LoadTexture("X.bmp", renderer), LoadTexture("O.bmp", renderer) };
 
-    TicTacToe::Grid game;
-    // Host plays X, guest plays O, host plays first
+    // Offline and in peer to peer, moves of both players are played on it. On a server, it follows the server match.
+    TicTacToe::Net::ClientMatch match;
+    // X plays first. In peer to peer the host plays X, on a server the match Start message tells our symbol
     const std::array<TicTacToe::Case, 2> players{ TicTacToe::Case::X, TicTacToe::Case::O };
-    uint8_t currentPlayingPlayer = 0;
+    TicTacToe::Case localSymbol = isHost ? TicTacToe::Case::X : TicTacToe::Case::O;
+    bool redraw = true;
+    auto setTurnState = [&]()
+    {
+        setState(match.turn() == localSymbol ? State::MyTurn : State::OpponentTurn);
+    };
     auto playCurrentTurnLocally = [&](unsigned int x, unsigned int y)
     {
-        const TicTacToe::Case currentPlayerSymbol = players[currentPlayingPlayer];
-        if (game.play(x, y, currentPlayerSymbol))
+        if (match.play(x, y))
         {
-            // If the move is successful, change current player to next one
-            currentPlayingPlayer = (currentPlayingPlayer + 1) % 2;
             setState(state == State::OpponentTurn ? State::MyTurn : State::OpponentTurn);
+            redraw = true;
             return true;
         }
         return false;
@@ -136,9 +146,7 @@ int main_merged(const bool isNetworked, const bool isHost = false)
 
     Bousk::Network::Address opponent;
 
-    NetListener netListener;
-    netService->addListener(&netListener);
-    netListener.mOnIncomingConnection = [&](const Bousk::Network::Messages::IncomingConnection& msg)
+    auto onIncomingConnection = [&](const Bousk::Network::Messages::IncomingConnection& msg)
     {
         if (netService->isHost() && state == State::WaitingOpponent)
         {
@@ -147,16 +155,30 @@ int main_merged(const bool isNetworked, const bool isHost = false)
         }
         return false;
     };
-    netListener.mOnConnectionResult = [&](const Bousk::Network::Messages::Connection& msg)
+    // Serialize the message right into a send buffer on the channel it needs, sent to the opponent, or the server, on next flush
+    auto send = [&](const auto& message)
+    {
+        if (!netService->send(opponent, message))
+        {
+            std::cout << "Critical error : failed to serialize packet" << std::endl;
+            assert(false);
+        }
+    };
+    auto onConnectionResult = [&](const Bousk::Network::Messages::Connection& msg)
     {
         if (state == State::WaitingConnection)
         {
             if (msg.result == Bousk::Network::Messages::Connection::Result::Success)
             {
-                // Save opponent address
+                // Save opponent address : the server relays moves when playing on a server
                 opponent = msg.emitter();
-                // Host plays first
-                setState(netService->isHost() ? State::MyTurn : State::OpponentTurn);
+                if (isServerClient)
+                {
+                    send(TicTacToe::Net::Hello());
+                    setState(State::WaitingOpponent);
+                }
+                else
+                    setState(localSymbol == players[0] ? State::MyTurn : State::OpponentTurn);
             }
             else if (netService->isHost())
             {
@@ -165,65 +187,139 @@ int main_merged(const bool isNetworked, const bool isHost = false)
             }
         }
     };
-    netListener.mOnDataReceived = [&](const Bousk::Network::Messages::UserData& msg)
+    auto onDataReceived = [&](const Bousk::Network::Messages::UserData& msg)
     {
-        Bousk::Serialization::Deserializer deserializer(msg.data.data(), msg.data.size());
-        TicTacToe::Net::Play play;
-        if (!play.read(deserializer))
+        TicTacToe::Net::PacketReader reader(msg.data.data(), msg.data.size());
+        TicTacToe::Net::MessageType type;
+        while (reader.next(type))
         {
-            std::cout << "Critical error : failed to deserialize play packet" << std::endl;
-            assert(false);
-        }
-        assert(state == State::OpponentTurn);
-        if (!playCurrentTurnLocally(play.x, play.y))
-        {
-            std::cout << "Critical error : failed to play move" << std::endl;
-            assert(false);
+            switch (type)
+            {
+                case TicTacToe::Net::MessageType::Start:
+                {
+                    TicTacToe::Net::Start start;
+                    if (!reader.read(start))
+                    {
+                        std::cout << "Critical error : failed to deserialize start message" << std::endl;
+                        assert(false);
+                        return;
+                    }
+                    // The server starts a new match as soon as the previous one is over
+                    match.start(start.symbol);
+                    localSymbol = start.symbol;
+                    redraw = true;
+                    setTurnState();
+                } break;
+                case TicTacToe::Net::MessageType::Seat:
+                {
+                    TicTacToe::Net::Seat seat;
+                    if (!reader.read(seat))
+                    {
+                        std::cout << "Critical error : failed to deserialize seat message" << std::endl;
+                        assert(false);
+                        return;
+                    }
+                    // Only needed to Rejoin : a disconnection ends this client, the opponent wins once the seat grace is over
+                    match.seat(seat);
+                } break;
+                case TicTacToe::Net::MessageType::Play:
+                {
+                    TicTacToe::Net::Play play;
+                    if (!reader.read(play))
+                    {
+                        std::cout << "Critical error : failed to deserialize play message" << std::endl;
+                        assert(false);
+                        return;
+                    }
+                    assert(state == State::OpponentTurn);
+                    if (!playCurrentTurnLocally(play.x, play.y))
+                    {
+                        std::cout << "Critical error : failed to play move" << std::endl;
+                        assert(false);
+                    }
+                } break;
+                case TicTacToe::Net::MessageType::Delta:
+                {
+                    TicTacToe::Net::Delta delta;
+                    if (!reader.read(delta))
+                    {
+                        std::cout << "Critical error : failed to deserialize delta message" << std::endl;
+                        assert(false);
+                        return;
+                    }
+                    switch (match.apply(delta))
+                    {
+                        case TicTacToe::Net::ClientMatch::DeltaResult::Applied:
+                            redraw = true;
+                            setTurnState();
+                            break;
+                        case TicTacToe::Net::ClientMatch::DeltaResult::OutOfSync:
+                            std::cout << "Out of sync with the server, resyncing" << std::endl;
+                            send(TicTacToe::Net::Resync());
+                            match.resyncSent();
+                            break;
+                        case TicTacToe::Net::ClientMatch::DeltaResult::Ignored:
+                            break;
+                    }
+                } break;
+                case TicTacToe::Net::MessageType::Snapshot:
+                {
+                    TicTacToe::Net::Snapshot snapshot;
+                    if (!reader.read(snapshot) || !match.restore(snapshot))
+                    {
+                        std::cout << "Critical error : failed to deserialize snapshot message" << std::endl;
+                        assert(false);
+                        return;
+                    }
+                    redraw = true;
+                    setTurnState();
+                } break;
+                default:
+                    std::cout << "Critical error : unexpected message" << std::endl;
+                    assert(false);
+                    return;
+            }
         }
     };
-    netListener.mOnDisconnection = [&](const Bousk::Network::Messages::Disconnection& msg)
+    auto onDisconnection = [&](const Bousk::Network::Messages::Disconnection& msg)
     {
         updateWindowTitle("Disconnected");
     };
-    while (1)
+    NetListener netListener(onIncomingConnection, onConnectionResult, onDisconnection, onDataReceived);
+    netService->addListener(&netListener);
+    auto handleEvent = [&](const SDL_Event& e)
     {
-        SDL_Event e;
-        if (SDL_PollEvent(&e))
+        redraw |= NeedsRedraw(e);
+        if (e.type == SDL_MOUSEBUTTONUP && (state == State::MyTurn || !netService->isNetworked()))
         {
-            if (e.type == SDL_QUIT)
+            if (e.button.button == SDL_BUTTON_LEFT)
             {
-                break;
-            }
-            if (e.type == SDL_MOUSEBUTTONUP && (state == State::MyTurn || !netService->isNetworked()))
-            {
-                if (e.button.button == SDL_BUTTON_LEFT)
+                if (e.button.x >= 0 && e.button.x <= WIN_W
+                    && e.button.y >= 0 && e.button.y <= WIN_H)
                 {
-                    if (e.button.x >= 0 && e.button.x <= WIN_W
-                        && e.button.y >= 0 && e.button.y <= WIN_H)
+                    // Click released on the window : play ?
+                    const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
+                    const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
+                    if (playCurrentTurnLocally(caseX, caseY))
                     {
-                        // Click released on the window : play ?
-                        const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
-                        const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
-                        if (playCurrentTurnLocally(caseX, caseY))
+                        if (netService->isNetworked())
                         {
-                            if (netService->isNetworked())
-                            {
-                                TicTacToe::Net::Play msg;
-                                msg.x = caseX;
-                                msg.y = caseY;
-                                Bousk::Serialization::Serializer serializer;
-                                if (!msg.write(serializer))
-                                {
-                                    std::cout << "Critical error : failed to serialize play packet" << std::endl;
-                                    assert(false);
-                                }
-                                netService->sendTo(opponent, serializer.buffer(), serializer.bufferSize());
-                            }
+                            TicTacToe::Net::Play msg;
+                            msg.x = caseX;
+                            msg.y = caseY;
+                            send(msg);
                         }
                     }
                 }
             }
         }
+    };
+    // Offline, nothing happens without user input. Networked, wake up when the network needs an update too.
+    const int eventsTimeoutMs = netService->isNetworked() ? NetworkTickMs : -1;
+    while (1)
+    {
+        if (!HandleEvents(eventsTimeoutMs, handleEvent))
+            break;
         // Receive network data
         netService->receive();
         // Process network data
@@ -231,47 +327,28 @@ int main_merged(const bool isNetworked, const bool isHost = false)
         // Send network data
         netService->flush();
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(renderer);
-        // Draw cases
-        for (int x = 0; x < 3; ++x)
+        if (redraw)
         {
-            for (int y = 0; y < 3; ++y)
-            {
-                const TicTacToe::Case caseStatus = game.grid()[x][y];
-                const SDL_Rect position{ x * CASE_W, y * CASE_H, CASE_W, CASE_H };
-                SDL_RenderCopy(renderer, plays[static_cast<unsigned int>(caseStatus)], NULL, &position);
-            }
-        }
-        // Draw grid lines
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-        // Horizontal
-        SDL_RenderDrawLine(renderer, 0, CASE_H, WIN_W, CASE_H);
-        SDL_RenderDrawLine(renderer, 0, CASE_H * 2, WIN_W, CASE_H * 2);
-        // Vertical
-        SDL_RenderDrawLine(renderer, CASE_W, 0, CASE_W, WIN_H);
-        SDL_RenderDrawLine(renderer, CASE_W * 2, 0, CASE_W * 2, WIN_H);
-
-        if (game.isFinished())
-        {
-            const TicTacToe::Case winner = game.winner();
-            if (winner != players[0] && winner != players[1])
-                updateWindowTitle("Draw");
-            else
+            if (match.grid().isFinished())
             {
-                if (netService->isNetworked())
-                {
-                    updateWindowTitle((winner == players[0]) == netService->isHost() ? "You win" : "You loose");
-                }
+                const TicTacToe::Case winner = match.grid().winner();
+                if (winner != players[0] && winner != players[1])
+                    updateWindowTitle("Draw");
                 else
                 {
-                    updateWindowTitle(winner == players[0] ? "Player 1 wins" : "Player 2 wins");
+                    if (netService->isNetworked())
+                    {
+                        updateWindowTitle(winner == localSymbol ? "You win" : "You loose");
+                    }
+                    else
+                    {
+                        updateWindowTitle(winner == players[0] ? "Player 1 wins" : "Player 2 wins");
+                    }
                 }
             }
+            RenderGame(renderer, plays, match.grid());
+            redraw = false;
         }
-
-        SDL_RenderPresent(renderer);
-        SDL_Delay(1);
     }
 
     for (SDL_Texture* texture : plays)
@@ -87,43 +87,44 @@ int main_p2p(const bool isHost)
     const TicTacToe::Case localPlayerSymbol = isHost ? TicTacToe::Case::X : TicTacToe::Case::O;
     // Save my opponent symbol too
     const TicTacToe::Case opponentSymbol = (localPlayerSymbol == TicTacToe::Case::X) ? TicTacToe::Case::O : TicTacToe::Case::X;
-    while (1)
+    bool redraw = true;
+    auto handleEvent = [&](const SDL_Event& e)
     {
-        SDL_Event e;
-        if (SDL_PollEvent(&e))
+        redraw |= NeedsRedraw(e);
+        if (e.type == SDL_MOUSEBUTTONUP && state == State::MyTurn)
         {
-            if (e.type == SDL_QUIT)
-            {
-                break;
-            }
-            if (e.type == SDL_MOUSEBUTTONUP && state == State::MyTurn)
+            if (e.button.button == SDL_BUTTON_LEFT)
             {
-                if (e.button.button == SDL_BUTTON_LEFT)
+                if (e.button.x >= 0 && e.button.x <= WIN_W
+                    && e.button.y >= 0 && e.button.y <= WIN_H)
                 {
-                    if (e.button.x >= 0 && e.button.x <= WIN_W
-                        && e.button.y >= 0 && e.button.y <= WIN_H)
+                    // Click released on the window : play ?
+                    const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
+                    const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
+                    if (game.play(caseX, caseY, localPlayerSymbol))
                     {
-                        // Click released on the window : play ?
-                        const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
-                        const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
-                        if (game.play(caseX, caseY, localPlayerSymbol))
+                        TicTacToe::Net::Play msg;
+                        msg.x = caseX;
+                        msg.y = caseY;
+                        Bousk::Serialization::Serializer serializer;
+                        if (!msg.write(serializer))
                         {
-                            TicTacToe::Net::Play msg;
-                            msg.x = caseX;
-                            msg.y = caseY;
-                            Bousk::Serialization::Serializer serializer;
-                            if (!msg.write(serializer))
-                            {
-                                std::cout << "Critical error : failed to serialize play packet" << std::endl;
-                                assert(false);
-                            }
-                            client.sendTo(opponent, serializer.buffer(), serializer.bufferSize(), 0);
-                            setState(State::OpponentTurn);
+                            std::cout << "Critical error : failed to serialize play packet" << std::endl;
+                            assert(false);
                         }
+                        client.sendTo(opponent, serializer.buffer(), serializer.bufferSize(), 0);
+                        setState(State::OpponentTurn);
+                        redraw = true;
                     }
                 }
             }
         }
+    };
+    while (1)
+    {
+        // Wake up on user input, or when the network needs an update
+        if (!HandleEvents(NetworkTickMs, handleEvent))
+            break;
         // Receive network data
         client.receive();
         // Process network data
@@ -174,6 +175,7 @@ int main_p2p(const bool isHost)
                     assert(false);
                 }
                 setState(State::MyTurn);
+                redraw = true;
             }
             else if (msg->is<Bousk::Network::Messages::Disconnection>())
             {
@@ -183,40 +185,21 @@ int main_p2p(const bool isHost)
         // Send network data
         client.processSend();
 
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(renderer);
-        // Draw cases
-        for (int x = 0; x < 3; ++x)
+        if (redraw)
         {
-            for (int y = 0; y < 3; ++y)
+            if (game.isFinished())
             {
-                const TicTacToe::Case caseStatus = game.grid()[x][y];
-                const SDL_Rect position{ x * CASE_W, y * CASE_H, CASE_W, CASE_H };
-                SDL_RenderCopy(renderer, plays[static_cast<unsigned int>(caseStatus)], NULL, &position);
+                const TicTacToe::Case winner = game.winner();
+                if (winner == localPlayerSymbol)
+                    updateWindowTitle("You win");
+                else if (winner == opponentSymbol)
+                    updateWindowTitle("You loose");
+                else
+                    updateWindowTitle("Draw");
             }
+            RenderGame(renderer, plays, game);
+            redraw = false;
         }
-        // Draw grid lines
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-        // Horizontal
-        SDL_RenderDrawLine(renderer, 0, CASE_H, WIN_W, CASE_H);
-        SDL_RenderDrawLine(renderer, 0, CASE_H * 2, WIN_W, CASE_H * 2);
-        // Vertical
-        SDL_RenderDrawLine(renderer, CASE_W, 0, CASE_W, WIN_H);
-        SDL_RenderDrawLine(renderer, CASE_W * 2, 0, CASE_W * 2, WIN_H);
-
-        if (game.isFinished())
-        {
-            const TicTacToe::Case winner = game.winner();
-            if (winner == localPlayerSymbol)
-                updateWindowTitle("You win");
-            else if (winner == opponentSymbol)
-                updateWindowTitle("You loose");
-            else
-                updateWindowTitle("Draw");
-        }
-
-        SDL_RenderPresent(renderer);
-        SDL_Delay(1);
     }
 
     for (SDL_Texture* texture : plays)
@@ -20,70 +20,50 @@ int main_solo()
     const TicTacToe::Case players[2] = { TicTacToe::Case::X, TicTacToe::Case::O };
     unsigned int playingPlayer = 0;
     updateWindowTitle(players[playingPlayer] == TicTacToe::Case::X ? "X" : "O");
-    while (1)
+    // Nothing happens without user input : sleep until an event comes
+    bool redraw = true;
+    auto handleEvent = [&](const SDL_Event& e)
     {
-        const TicTacToe::Case currentPlayer = players[playingPlayer];
-        SDL_Event e;
-        if (SDL_PollEvent(&e))
+        redraw |= NeedsRedraw(e);
+        if (e.type == SDL_MOUSEBUTTONUP && !game.isFinished())
         {
-            if (e.type == SDL_QUIT)
-            {
-                break;
-            }
-            if (e.type == SDL_MOUSEBUTTONUP && !game.isFinished())
+            if (e.button.button == SDL_BUTTON_LEFT)
             {
-                if (e.button.button == SDL_BUTTON_LEFT)
+                if (e.button.x >= 0 && e.button.x <= WIN_W
+                    && e.button.y >= 0 && e.button.y <= WIN_H)
                 {
-                    if (e.button.x >= 0 && e.button.x <= WIN_W
-                        && e.button.y >= 0 && e.button.y <= WIN_H)
+                    // Click released on the window : play ?
+                    const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
+                    const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
+                    if (game.play(caseX, caseY, players[playingPlayer]))
                     {
-                        // Click released on the window : play ?
-                        const unsigned int caseX = static_cast<unsigned int>(e.button.x / CASE_W);
-                        const unsigned int caseY = static_cast<unsigned int>(e.button.y / CASE_H);
-                        if (game.play(caseX, caseY, currentPlayer))
-                        {
-                            playingPlayer = (playingPlayer + 1) % 2;
-                            updateWindowTitle(players[playingPlayer] == TicTacToe::Case::X ? "X" : "O");
-                        }
+                        playingPlayer = (playingPlayer + 1) % 2;
+                        updateWindowTitle(players[playingPlayer] == TicTacToe::Case::X ? "X" : "O");
+                        redraw = true;
                     }
                 }
             }
         }
-
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-        SDL_RenderClear(renderer);
-        // Draw cases
-        for (int x = 0; x < 3; ++x)
+    };
+    while (1)
+    {
+        if (redraw)
         {
-            for (int y = 0; y < 3; ++y)
+            if (game.isFinished())
             {
-                const TicTacToe::Case caseStatus = game.grid()[x][y];
-                const SDL_Rect position{ x * CASE_W, y * CASE_H, CASE_W, CASE_H };
-                SDL_RenderCopy(renderer, plays[static_cast<unsigned int>(caseStatus)], NULL, &position);
+                const TicTacToe::Case winner = game.winner();
+                if (winner == TicTacToe::Case::X)
+                    updateWindowTitle("X wins");
+                else if (winner == TicTacToe::Case::O)
+                    updateWindowTitle("O wins");
+                else
+                    updateWindowTitle("Draw");
             }
+            RenderGame(renderer, plays, game);
+            redraw = false;
         }
-        // Draw grid lines
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-        // Horizontal
-        SDL_RenderDrawLine(renderer, 0, CASE_H, WIN_W, CASE_H);
-        SDL_RenderDrawLine(renderer, 0, CASE_H * 2, WIN_W, CASE_H * 2);
-        // Vertical
-        SDL_RenderDrawLine(renderer, CASE_W, 0, CASE_W, WIN_H);
-        SDL_RenderDrawLine(renderer, CASE_W * 2, 0, CASE_W * 2, WIN_H);
-
-        if (game.isFinished())
-        {
-            const TicTacToe::Case winner = game.winner();
-            if (winner == TicTacToe::Case::X)
-                updateWindowTitle("X wins");
-            else if (winner == TicTacToe::Case::O)
-                updateWindowTitle("O wins");
-            else
-                updateWindowTitle("Draw");
-        }
-
-        SDL_RenderPresent(renderer);
-        SDL_Delay(1);
+        if (!HandleEvents(-1, handleEvent))
+            break;
     }
 
     for (SDL_Texture* texture : plays)